@@ -16,24 +16,58 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #pragma once
-// Set the mouse settings to a comfortable speed/accuracy trade-off,
-// assuming a screen refresh rate of 60 Htz or higher
-// The default is 50. This makes the mouse ~3 times faster and more accurate
-#define MOUSEKEY_INTERVAL 16
-// The default is 20. Since we made the mouse about 3 times faster with the previous setting,
-// give it more time to accelerate to max speed to retain precise control over short distances.
-#define MOUSEKEY_TIME_TO_MAX 40
-// The default is 300. Let's try and make this as low as possible while keeping the cursor responsive
-#define MOUSEKEY_DELAY 100
-// It makes sense to use the same delay for the mouseweel
-#define MOUSEKEY_WHEEL_DELAY 100
-// The default is 100
-#define MOUSEKEY_WHEEL_INTERVAL 50
-// The default is 40
-#define MOUSEKEY_WHEEL_TIME_TO_MAX 100
+// The cursor and wheel keys of the pointer layer run through pointer.c, QMK's mousekeys only handle the buttons.
+// Frames are aligned to a 60 Htz screen refresh. Speeds are in 1/256 px (or wheel steps) per frame, friction in
+// 1/256 of the speed per frame. Plot the curves with tools/pointer_curves.py
+#define POINTER_FRAME_MS 16
+// 2 px on the press itself, accelerating to 20 px per frame (1200 px/s) in about 0.8 s
+#define POINTER_START_SPEED 512
+#define POINTER_ACCEL 96
+#define POINTER_MAX_SPEED 5120
+// Glide out for about 150 ms after release
+#define POINTER_FRICTION 96
+#define POINTER_STOP_SPEED 64
+// From 8 to 45 steps a second in about 0.6 s, and about 0.75 s of coasting after release
+#define WHEEL_START_SPEED 32
+#define WHEEL_ACCEL 4
+#define WHEEL_MAX_SPEED 192
+#define WHEEL_FRICTION 16
+#define WHEEL_STOP_SPEED 16
 
 // Pick good defaults for enabling homerow modifiers
 #define TAPPING_TERM 200
 #define TAPPING_TERM_PER_KEY
 #define PERMISSIVE_HOLD
 #define QUICK_TAP_TERM 0
+// Both terms are defaults only, they can be changed at run time, see tuning.h
+#define QUICK_TAP_TERM_PER_KEY
+// Keep the keycodes of a sparse top layer in RAM (about 90 bytes), refilled after each layer change. Off: QMK
+// still walks the layers on every lookup, and tests/bench_keycode_cache.c shows no gain worth the RAM
+// #define KEYCODE_CACHE
+// Type a home row mod straight away when it follows a letter this quickly, as it is then part of a word
+#define TYPING_STREAK_TERM 120
+// Settle a home row mod by the half the next key is on: the other half holds, the same half taps.
+// The tap dance hold tiers follow it too, through TAP_DANCE_PERMISSIVE_HOLD
+#define OPPOSITE_HAND_HOLD
+// Also takes the thumb layers as soon as the next key goes down, see the hold policies in tap_hold.h
+#define HOLD_ON_OTHER_KEY_PRESS_PER_KEY
+// Tune each key's tapping term to how long it is actually held when tapped, and keep it in EEPROM
+// #define TAPPING_TERM_ADAPTIVE
+// The learned terms take the first 32 bytes, the tuning parameters the rest
+#define EECONFIG_USER_DATA_SIZE 64
+// Let a nested tap of another key resolve the hold tier of a tap dance, just like PERMISSIVE_HOLD does for mod-taps
+#define TAP_DANCE_PERMISSIVE_HOLD
+// Make the symbol layer's home row mod-taps instead of tap dances, the paired symbol is typed with Shift instead
+// of a double tap
+// #define SYMBOL_MOD_TAPS
+// Type the paired symbols (TD_PAIR in tap_dance.h) on the press, their partner with Shift or the PARTNER thumb.
+// Along with SYMBOL_MOD_TAPS, every key of the symbol layer then resolves on its first press
+// #define TAP_DANCE_OVERRIDES
+
+// The secondary half only sends its matrix when the checksum QMK sends every scan changes, so an idle scan is a
+// single byte over the wire. What is left to gain is the bit rate: 0 is the fastest soft serial speed, 1 the default.
+// #define SELECT_SOFT_SERIAL_SPEED 0
+#ifdef SCAN_SCHEDULER_ENABLE
+// Keep the secondary half at full rate while the primary one is in use, see scan_sched.h
+#    define SPLIT_ACTIVITY_ENABLE
+#endif
@@ -0,0 +1,101 @@
+/* Per-key debounce with a policy for each matrix position, see debounce_policy in keymap.c.
+ *
+ * 'E' (eager press): a press is reported on its first edge, and the key then ignores
+ *     its contacts for DEBOUNCE ms so the bounce that follows is not seen. A release is
+ *     only reported once the key has read released for DEBOUNCE ms in a row.
+ * 'D' (deferred): both edges are reported once the key has read the same for DEBOUNCE
+ *     ms in a row, so a single noisy read can never register a press.
+ *
+ * Enabled with DEBOUNCE_TYPE = custom in rules.mk.
+ */
+#include QMK_KEYBOARD_H
+
+#include "debounce.h"
+#ifdef SCAN_PROFILE_ENABLE
+#    include "profile.h"
+#endif
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+_Static_assert(DEBOUNCE > 0 && DEBOUNCE < 128, "DEBOUNCE must fit the 7 bit countdown");
+
+// Set on a countdown that locks a key after an eager press, clear on one that waits for the key to settle
+#define DEBOUNCE_LOCKED 0x80
+
+// Defined in keymap.c
+extern const char debounce_policy[MATRIX_ROWS][MATRIX_COLS];
+
+// Per key countdown in ms, 0 when the key is idle
+static uint8_t  countdowns[MATRIX_ROWS][MATRIX_COLS];
+static uint16_t last_time;
+
+void debounce_init(uint8_t num_rows) {
+    last_time = timer_read();
+}
+
+void debounce_free(void) {}
+
+static uint8_t first_row(uint8_t num_rows) {
+#ifdef SPLIT_KEYBOARD
+    // Each half only debounces its own rows.
+    if (num_rows < MATRIX_ROWS && !is_keyboard_left()) return MATRIX_ROWS - num_rows;
+#endif
+    return 0;
+}
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+#ifdef SCAN_PROFILE_ENABLE
+    profile_stage(PROFILE_DEBOUNCE);
+#endif
+    uint16_t now     = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, last_time);
+    last_time        = now;
+    if (elapsed > DEBOUNCE) elapsed = DEBOUNCE;
+
+    uint8_t offset         = first_row(num_rows);
+    bool    cooked_changed = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t differs = raw[row] ^ cooked[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t     *countdown = &countdowns[offset + row][col];
+            matrix_row_t bit       = (matrix_row_t)1 << col;
+
+            if (*countdown) {
+                uint8_t remaining = *countdown & ~DEBOUNCE_LOCKED;
+                remaining         = remaining > elapsed ? remaining - elapsed : 0;
+                if (*countdown & DEBOUNCE_LOCKED) {
+                    // The bounce after an eager press is ignored until the lock runs out.
+                    *countdown = remaining ? DEBOUNCE_LOCKED | remaining : 0;
+                    if (remaining) continue;
+                } else {
+                    // Back to the reported state before settling: it was bounce or noise.
+                    if (!(differs & bit)) {
+                        *countdown = 0;
+                        continue;
+                    }
+                    *countdown = remaining;
+                    if (!remaining) {
+                        cooked[row] ^= bit;
+                        cooked_changed = true;
+                    }
+                    continue;
+                }
+            }
+            if (!(differs & bit)) continue;
+
+            if ((raw[row] & bit) && pgm_read_byte(&debounce_policy[offset + row][col]) == 'E') {
+                cooked[row] |= bit;
+                *countdown     = DEBOUNCE_LOCKED | DEBOUNCE;
+                cooked_changed = true;
+            } else {
+                *countdown = DEBOUNCE;
+            }
+        }
+    }
+#ifdef SCAN_PROFILE_ENABLE
+    profile_stage(PROFILE_TRANSPORT);
+#endif
+    return cooked_changed;
+}
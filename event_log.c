@@ -0,0 +1,121 @@
+#include QMK_KEYBOARD_H
+
+#include "event_log.h"
+
+typedef struct {
+    uint32_t time;
+    uint8_t  type;
+    uint8_t  a;
+    uint8_t  b;
+    uint8_t  c;
+} event_log_record_t;
+
+// Records printed per housekeeping pass, so draining never stalls the scan for long
+#define EVENT_LOG_DRAIN_BATCH 4
+
+static event_log_record_t records[EVENT_LOG_SIZE];
+static uint8_t            head;  // Next record to write
+static uint8_t            count; // Records held, the oldest is overwritten once full
+static uint8_t            drain_next; // Next record to print
+static uint8_t            draining;   // Records left to print
+static uint8_t            last_mods, last_key, last_keys;
+static bool               streaming;
+// Keys down as seen by QMK, for the stuck report check
+static matrix_row_t       held[MATRIX_ROWS];
+static uint16_t           released_at;
+static bool               stuck_logged;
+
+static void event_log_push(uint8_t type, uint8_t a, uint8_t b, uint8_t c) {
+    event_log_record_t *record = &records[head];
+    record->time               = timer_read32();
+    record->type               = type;
+    record->a                  = a;
+    record->b                  = b;
+    record->c                  = c;
+    head                       = (head + 1) & (EVENT_LOG_SIZE - 1);
+    if (count < EVENT_LOG_SIZE) count++;
+
+    if (streaming) {
+        if (draining < EVENT_LOG_SIZE) {
+            draining++;
+        } else {
+            // The oldest record not printed yet was just overwritten, carry on from the one after it.
+            drain_next = head;
+        }
+    }
+}
+
+void event_log_key(keyrecord_t *record) {
+    keypos_t     key  = record->event.key;
+    matrix_row_t mask = (matrix_row_t)1 << key.col;
+    if (record->event.pressed) {
+        held[key.row] |= mask;
+    } else {
+        held[key.row] &= ~mask;
+        released_at = timer_read();
+    }
+    event_log_push(record->event.pressed ? EVENT_LOG_KEY_DOWN : EVENT_LOG_KEY_UP, key.row << 4 | key.col, get_highest_layer(layer_state | default_layer_state), 0);
+}
+
+void event_log_dance(uint8_t dance, uint8_t state) {
+    event_log_push(EVENT_LOG_DANCE, dance, state, 0);
+}
+
+void event_log_report(void) {
+    uint8_t mods = keyboard_report->mods;
+    uint8_t key  = KC_NO;
+    uint8_t keys = 0;
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (keyboard_report->keys[i] == KC_NO) continue;
+        if (!keys++) key = keyboard_report->keys[i];
+    }
+    if (mods == last_mods && key == last_key && keys == last_keys) return;
+    last_mods = mods;
+    last_key  = key;
+    last_keys = keys;
+    event_log_push(EVENT_LOG_REPORT, mods, key, keys);
+}
+
+void event_log_dump(void) {
+    drain_next = (head - count) & (EVENT_LOG_SIZE - 1);
+    draining   = count;
+}
+
+void event_log_stream(bool on) {
+    if (on && !streaming) {
+        drain_next = head;
+        draining   = 0;
+    }
+    streaming = on;
+}
+
+static bool keys_held(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (held[row]) return true;
+    }
+    return false;
+}
+
+static void event_log_check_stuck(void) {
+    if (keys_held() || !(last_mods || last_keys)) {
+        stuck_logged = false;
+        return;
+    }
+    if (!stuck_logged && timer_elapsed(released_at) > EVENT_LOG_STUCK_TERM) {
+        stuck_logged = true;
+        event_log_push(EVENT_LOG_STUCK, last_mods, last_key, last_keys);
+    }
+}
+
+void event_log_task(void) {
+    // Reports sent outside of key processing, such as a tapping term running out, are caught here.
+    event_log_report();
+    event_log_check_stuck();
+
+    for (uint8_t i = 0; i < EVENT_LOG_DRAIN_BATCH && draining; i++, draining--) {
+        // Oldest first. Records logged during a dump wait for the next one, unless streaming.
+        event_log_record_t *record = &records[drain_next];
+        drain_next                 = (drain_next + 1) & (EVENT_LOG_SIZE - 1);
+        uprintf("ev %lu %u %u %u %u\n", (unsigned long)record->time, record->type, record->a, record->b, record->c);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef FERRIS_SWEEP_EVENT_LOG_H
+#define FERRIS_SWEEP_EVENT_LOG_H
+
+/* Ring buffer of the last EVENT_LOG_SIZE key events, tap dance resolutions and
+ * keyboard reports, each stamped with timer_read32().
+ *
+ * Recording only copies a few bytes into RAM, printing happens when the log is
+ * drained. event_log_dump() starts that, the housekeeping task then prints a few
+ * records per pass as "ev <time> <type> <a> <b> <c>" lines. tools/event_log.py
+ * turns a console capture of them into a per-keystroke timeline.
+ *
+ * event_log_stream() prints every record as it is logged instead, for capturing a
+ * whole typing session. A report that still holds keys or mods EVENT_LOG_STUCK_TERM
+ * ms after the last key went up is logged as stuck: something was registered and
+ * never unregistered.
+ */
+
+#ifndef EVENT_LOG_SIZE
+#    define EVENT_LOG_SIZE 32
+#endif
+
+#ifndef EVENT_LOG_STUCK_TERM
+#    define EVENT_LOG_STUCK_TERM 500
+#endif
+
+_Static_assert((EVENT_LOG_SIZE & (EVENT_LOG_SIZE - 1)) == 0 && EVENT_LOG_SIZE <= 256, "EVENT_LOG_SIZE must be a power of two, up to 256");
+
+enum event_log_type {
+    EVENT_LOG_KEY_DOWN, // a: row << 4 | col, b: highest active layer
+    EVENT_LOG_KEY_UP,   // a: row << 4 | col, b: highest active layer
+    EVENT_LOG_DANCE,    // a: dance, b: td_state_t it resolved to
+    EVENT_LOG_REPORT,   // a: mods, b: first key, c: number of keys
+    EVENT_LOG_STUCK,    // Same as EVENT_LOG_REPORT, for the report left over once every key is up
+};
+
+void event_log_key(keyrecord_t *record);
+void event_log_dance(uint8_t dance, uint8_t state);
+// Log the keyboard report if it changed since the last one logged.
+void event_log_report(void);
+void event_log_dump(void);
+void event_log_stream(bool on);
+void event_log_task(void);
+
+#endif
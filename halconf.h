@@ -0,0 +1,8 @@
+#pragma once
+
+// The scan scheduler sleeps until a key pin changes, see scan_sched.c
+#ifdef SCAN_SCHEDULER_ENABLE
+#    define PAL_USE_CALLBACKS TRUE
+#endif
+
+#include_next <halconf.h>
@@ -0,0 +1,35 @@
+#ifndef FERRIS_SWEEP_HISTOGRAM_H
+#define FERRIS_SWEEP_HISTOGRAM_H
+
+/* Half-octave buckets for fixed-memory histograms of durations.
+ *
+ * Values 0 to 3 get a bucket each, then every power of two is split in two by the
+ * bit below the top one: 4-5, 6-7, 8-11, 12-15 and so on. 20 buckets reach 1024,
+ * 32 cover every uint16_t. Shared by profile.c (µs) and latency.c (ms).
+ */
+
+static inline uint8_t histogram_bucket(uint16_t value) {
+    if (value < 4) return value;
+    uint8_t bits = sizeof(unsigned) * 8 - __builtin_clz(value);
+    return (bits - 1) * 2 + ((value >> (bits - 2)) & 1);
+}
+
+// First value past the bucket, so a percentile read from it is an upper bound.
+static inline uint32_t histogram_bucket_end(uint8_t bucket) {
+    if (bucket < 4) return bucket + 1;
+    uint8_t bits = bucket / 2 + 1;
+    return (uint32_t)(3 + (bucket & 1)) << (bits - 2);
+}
+
+// Bucket holding the given percentile of count values.
+static inline uint8_t histogram_percentile(const uint16_t *buckets, uint8_t size, uint16_t count, uint8_t percent) {
+    uint16_t wanted = count - (uint32_t)count * (100 - percent) / 100;
+    uint16_t seen   = 0;
+    uint8_t  bucket = 0;
+    while (bucket < size - 1 && (seen += buckets[bucket]) < wanted) {
+        bucket++;
+    }
+    return bucket;
+}
+
+#endif
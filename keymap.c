@@ -1,15 +1,58 @@
 #include QMK_KEYBOARD_H
 
+#include "layers.h"
+#include "pointer.h"
+#include "sparse_layers.h"
 #include "tap_dance.h"
+#include "tap_hold.h"
+#include "tuning.h"
+#ifdef LATENCY_ENABLE
+#    include "latency.h"
+#endif
+#ifdef EVENT_LOG_ENABLE
+#    include "event_log.h"
+#endif
+#ifdef SPLIT_TIME_ENABLE
+#    include "split_time.h"
+#endif
+#ifdef SCAN_PROFILE_ENABLE
+#    include "profile.h"
+#endif
+#ifdef SCAN_SCHEDULER_ENABLE
+#    include "scan_sched.h"
+#endif
 
-enum layer_names {
-    BASE,
-    SYMBOL,
-    FUNCTION,
-    NAVIGATION,
-    MEDIA,
+enum custom_keycodes {
+    STATS = SAFE_RANGE, // Print the typing statistics, latencies, the scan profile and the event log on the console
+    LOG_LIVE,           // Toggle streaming the event log to the console, to record a typing session
+    PARTNER,            // Held, the paired symbol dances type their partner, see TD_PAIR
 };
 
+#ifdef SYMBOL_MOD_TAPS
+/* The symbol layer's home row as mod-taps, so its holds settle as fast as the base layer's.
+ * A mod-tap can only carry a basic keycode, the symbol itself is typed by symbol_mod_tap().
+ *
+ *  dance               mod-tap          tap      with Shift */
+#    define SYMBOL_MOD_TAP_TABLE(X) \
+        X(GRAVE_TILDE,       LGUI_T(KC_GRV),  KC_GRV,  KC_TILD) \
+        X(AMPERSAND_PIPE,    LALT_T(KC_7),    KC_AMPR, KC_PIPE) \
+        X(BRACES,            LCTL_T(KC_LBRC), KC_LBRC, KC_RBRC) \
+        X(PARANTHESIS,       LSFT_T(KC_9),    KC_LPRN, KC_RPRN) \
+        X(QUOTE_DOUBLEQUOTE, RSFT_T(KC_QUOT), KC_QUOT, KC_DQUO) \
+        X(EQUAL_PLUS,        RCTL_T(KC_EQL),  KC_EQL,  KC_PLUS) \
+        X(UNDERSCORE_MINUS,  RALT_T(KC_MINS), KC_UNDS, KC_MINS)
+
+#    define SYMBOL_MOD_TAP_ENUM(dance, mod_tap, ...) SMT_##dance = mod_tap,
+
+enum {
+    SYMBOL_MOD_TAP_TABLE(SYMBOL_MOD_TAP_ENUM)
+};
+
+#    define SYMBOL_KEY(dance) SMT_##dance
+#else
+#    define SYMBOL_KEY(dance) TD(dance)
+#endif
+
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     [BASE] = LAYOUT_split_3x5_2(
         /*L11*/ TD(Q_ESCAPE),
@@ -44,8 +87,8 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
         /*R35*/ KC_SLSH,
         /*L41*/ LT(MEDIA, KC_TAB),
         /*L42*/ LT(NAVIGATION, KC_SPC),
-        /*L41*/ LT(SYMBOL, KC_BSPC),
-        /*L42*/ LT(FUNCTION, KC_ENT)
+        /*R41*/ LT(SYMBOL, KC_BSPC),
+        /*R42*/ LT(FUNCTION, KC_ENT)
     ),
     [SYMBOL] = LAYOUT_split_3x5_2(
         /*L11*/ KC_1,
@@ -58,15 +101,15 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
         /*R13*/ KC_8,
         /*R14*/ KC_9,
         /*R15*/ KC_0,
-        /*L21*/ TD(GRAVE_TILDE),
-        /*L22*/ TD(AMPERSAND_PIPE),
-        /*L23*/ TD(BRACES),
-        /*L24*/ TD(PARANTHESIS),
+        /*L21*/ SYMBOL_KEY(GRAVE_TILDE),
+        /*L22*/ SYMBOL_KEY(AMPERSAND_PIPE),
+        /*L23*/ SYMBOL_KEY(BRACES),
+        /*L24*/ SYMBOL_KEY(PARANTHESIS),
         /*L25*/ KC_PERC,
         /*R21*/ TD(QUESTION_EXCLAMATION),
-        /*R22*/ TD(QUOTE_DOUBLEQUOTE),
-        /*R23*/ TD(EQUAL_PLUS),
-        /*R24*/ TD(UNDERSCORE_MINUS),
+        /*R22*/ SYMBOL_KEY(QUOTE_DOUBLEQUOTE),
+        /*R23*/ SYMBOL_KEY(EQUAL_PLUS),
+        /*R24*/ SYMBOL_KEY(UNDERSCORE_MINUS),
         /*R25*/ TD(SEMICOLON_COLON),
         /*L31*/ XXXXXXX,
         /*L32*/ KC_HASH,
@@ -78,46 +121,10 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
         /*R33*/ TD(LESSTHAN_GREATERTHAN),
         /*R34*/ TD(SLASH_BACKSLASH),
         /*R35*/ XXXXXXX,
-        /*L41*/ XXXXXXX,
+        /*L41*/ PARTNER,
         /*L42*/ KC_SPC,
-        /*L41*/ XXXXXXX,
-        /*L42*/ XXXXXXX
-    ),
-    [FUNCTION] = LAYOUT_split_3x5_2(
-        /*L11*/ KC_F1,
-        /*L12*/ KC_F2,
-        /*L13*/ KC_F3,
-        /*L14*/ KC_F4,
-        /*L15*/ KC_F5,
-        /*R11*/ KC_F6,
-        /*R12*/ KC_F7,
-        /*R13*/ KC_F8,
-        /*R14*/ KC_F9,
-        /*R15*/ KC_F10,
-        /*L21*/ XXXXXXX,
-        /*L22*/ XXXXXXX,
-        /*L23*/ XXXXXXX,
-        /*L24*/ XXXXXXX,
-        /*L25*/ XXXXXXX,
-        /*R21*/ XXXXXXX,
-        /*R22*/ KC_F11,
-        /*R23*/ KC_F12,
-        /*R24*/ XXXXXXX,
-        /*R25*/ XXXXXXX,
-        /*L31*/ XXXXXXX,
-        /*L32*/ XXXXXXX,
-        /*L33*/ XXXXXXX,
-        /*L34*/ XXXXXXX,
-        /*L35*/ XXXXXXX,
-        /*R31*/ XXXXXXX,
-        /*R32*/ XXXXXXX,
-        /*R33*/ XXXXXXX,
-        /*R34*/ XXXXXXX,
-        /*R35*/ XXXXXXX,
-        /*L41*/ XXXXXXX,
-        /*L42*/ XXXXXXX,
-        /*L41*/ XXXXXXX,
-        /*L42*/ XXXXXXX
+        /*R41*/ XXXXXXX,
+        /*R42*/ XXXXXXX
     ),
     [NAVIGATION] = LAYOUT_split_3x5_2(
         /*L11*/ KC_ESC,
@@ -150,45 +157,239 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
         /*R33*/ KC_PGUP,
         /*R34*/ KC_END,
         /*R35*/ XXXXXXX,
-        /*L41*/ XXXXXXX,
-        /*L42*/ XXXXXXX,
-        /*L41*/ XXXXXXX,
-        /*L42*/ XXXXXXX
-    ),
-    [MEDIA] = LAYOUT_split_3x5_2(
-        /*L11*/ XXXXXXX,
-        /*L12*/ XXXXXXX,
-        /*L13*/ XXXXXXX,
-        /*L14*/ XXXXXXX,
-        /*L15*/ XXXXXXX,
-        /*R11*/ XXXXXXX,
-        /*R12*/ XXXXXXX,
-        /*R13*/ KC_MRWD,
-        /*R14*/ KC_MFFD,
-        /*R15*/ XXXXXXX,
-        /*L21*/ XXXXXXX,
-        /*L22*/ XXXXXXX,
-        /*L23*/ XXXXXXX,
-        /*L24*/ XXXXXXX,
-        /*L25*/ XXXXXXX,
-        /*R21*/ KC_MPLY,
-        /*R22*/ KC_VOLD,
-        /*R23*/ KC_VOLU,
-        /*R24*/ KC_MUTE,
-        /*R25*/ XXXXXXX,
-        /*L31*/ XXXXXXX,
-        /*L32*/ XXXXXXX,
-        /*L33*/ XXXXXXX,
-        /*L34*/ XXXXXXX,
-        /*L35*/ XXXXXXX,
-        /*R31*/ XXXXXXX,
-        /*R32*/ KC_BRID,
-        /*R33*/ KC_BRIU,
-        /*R34*/ XXXXXXX,
-        /*R35*/ XXXXXXX,
-        /*L41*/ XXXXXXX,
-        /*L42*/ XXXXXXX,
-        /*L41*/ XXXXXXX,
-        /*L42*/ XXXXXXX
+        /*L41*/ _______, // The base layer thumbs, so NAVIGATION and MEDIA held together reach POINTER
+        /*L42*/ _______,
+        /*R41*/ XXXXXXX,
+        /*R42*/ XXXXXXX
     ),
 };
+
+_Static_assert(ARRAY_SIZE(keymaps) == FIRST_SPARSE_LAYER, "keymaps[] holds exactly the dense layers");
+
+// Mostly empty layers, only the keys in use are stored. Entries go in layout order.
+#define FUNCTION_KEYS(X) \
+    X(L11, KC_F1) \
+    X(L12, KC_F2) \
+    X(L13, KC_F3) \
+    X(L14, KC_F4) \
+    X(L15, KC_F5) \
+    X(R11, KC_F6) \
+    X(R12, KC_F7) \
+    X(R13, KC_F8) \
+    X(R14, KC_F9) \
+    X(R15, KC_F10) \
+    X(L23, LOG_LIVE) \
+    X(L25, STATS) \
+    X(R22, KC_F11) \
+    X(R23, KC_F12)
+
+#define MEDIA_KEYS(X) \
+    X(R13, KC_MRWD) \
+    X(R14, KC_MFFD) \
+    X(R21, KC_MPLY) \
+    X(R22, KC_VOLD) \
+    X(R23, KC_VOLU) \
+    X(R24, KC_MUTE) \
+    X(R32, KC_BRID) \
+    X(R33, KC_BRIU) \
+    X(L41, KC_TRNS) \
+    X(L42, KC_TRNS)
+
+#define POINTER_KEYS(X) \
+    X(L22, KC_BTN2) \
+    X(L23, KC_BTN3) \
+    X(L24, KC_BTN1) \
+    X(R21, KC_MS_L) \
+    X(R22, KC_MS_D) \
+    X(R23, KC_MS_U) \
+    X(R24, KC_MS_R) \
+    X(R31, KC_WH_L) \
+    X(R32, KC_WH_D) \
+    X(R33, KC_WH_U) \
+    X(R34, KC_WH_R)
+
+SPARSE_LAYER_KEYCODES(function, FUNCTION_KEYS)
+SPARSE_LAYER_KEYCODES(media, MEDIA_KEYS)
+SPARSE_LAYER_KEYCODES(pointer, POINTER_KEYS)
+
+const sparse_layer_t sparse_layers[] PROGMEM = {
+    [FUNCTION - FIRST_SPARSE_LAYER] = SPARSE_LAYER(function, FUNCTION_KEYS),
+    [MEDIA - FIRST_SPARSE_LAYER]    = SPARSE_LAYER(media, MEDIA_KEYS),
+    [POINTER - FIRST_SPARSE_LAYER]  = SPARSE_LAYER(pointer, POINTER_KEYS),
+};
+
+_Static_assert(ARRAY_SIZE(sparse_layers) == LAYER_COUNT - FIRST_SPARSE_LAYER, "Every sparse layer needs an entry in sparse_layers[]");
+
+#ifdef OPPOSITE_HAND_HOLD
+const char handedness[MATRIX_ROWS][MATRIX_COLS] PROGMEM = LAYOUT_split_3x5_2(
+    'L', 'L', 'L', 'L', 'L',    'R', 'R', 'R', 'R', 'R',
+    'L', 'L', 'L', 'L', 'L',    'R', 'R', 'R', 'R', 'R',
+    'L', 'L', 'L', 'L', 'L',    'R', 'R', 'R', 'R', 'R',
+                   '*', '*',    '*', '*'
+);
+#endif
+
+// Alphas register on the first contact ('E'), the thumbs wait for their switch to settle ('D'), see debounce.c
+const char debounce_policy[MATRIX_ROWS][MATRIX_COLS] PROGMEM = LAYOUT_split_3x5_2(
+    'E', 'E', 'E', 'E', 'E',    'E', 'E', 'E', 'E', 'E',
+    'E', 'E', 'E', 'E', 'E',    'E', 'E', 'E', 'E', 'E',
+    'E', 'E', 'E', 'E', 'E',    'E', 'E', 'E', 'E', 'E',
+                   'D', 'D',    'D', 'D'
+);
+
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+    if (td_replaying()) return td_pre_process_record(keycode, record);
+#ifdef SPLIT_TIME_ENABLE
+    split_time_correct(record);
+#endif
+#ifdef EVENT_LOG_ENABLE
+    event_log_key(record);
+#endif
+    return tap_hold_pre_process_record(keycode, record) && td_pre_process_record(keycode, record);
+}
+
+#ifdef SYMBOL_MOD_TAPS
+// Type the symbol of a tapped symbol mod-tap, the one paired with it when Shift is held.
+static bool symbol_tap(keyrecord_t *record, uint16_t tap, uint16_t shifted) {
+    if (!record->tap.count) return true; // Held, QMK registers the modifier
+    if (record->event.pressed) {
+        uint8_t shift = get_mods() & MOD_MASK_SHIFT;
+        if (shift) {
+            del_mods(shift);
+            tap_code16(shifted);
+            add_mods(shift);
+        } else {
+            tap_code16(tap);
+        }
+    }
+    return false;
+}
+
+#    define SYMBOL_MOD_TAP_CASE(dance, mod_tap, tap, shifted) \
+        case mod_tap:                                         \
+            return symbol_tap(record, tap, shifted);
+
+static bool symbol_mod_tap(uint16_t keycode, keyrecord_t *record) {
+    switch (keycode) {
+        SYMBOL_MOD_TAP_TABLE(SYMBOL_MOD_TAP_CASE)
+    }
+    return true;
+}
+#endif
+
+bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    td_process_record(keycode, record);
+    if (!pointer_process_record(keycode, record)) return false;
+#ifdef SYMBOL_MOD_TAPS
+    if (!symbol_mod_tap(keycode, record)) {
+        // QMK skips post_process_record_user() for it, tap_hold.c still has to see the tap.
+        tap_hold_record(keycode, record);
+        return false;
+    }
+#endif
+    switch (keycode) {
+        case STATS:
+            if (record->event.pressed) {
+                tap_hold_print_stats();
+#ifdef LATENCY_HISTOGRAM_ENABLE
+                latency_print();
+                // With Shift, the histograms start over.
+                if (get_mods() & MOD_MASK_SHIFT) latency_reset();
+#endif
+#ifdef SCAN_SCHEDULER_ENABLE
+                scan_sched_print_stats();
+#endif
+#ifdef SCAN_PROFILE_ENABLE
+                profile_print();
+#endif
+#ifdef EVENT_LOG_ENABLE
+                event_log_dump();
+#endif
+            }
+            return false;
+        case LOG_LIVE:
+#ifdef EVENT_LOG_ENABLE
+            if (record->event.pressed) {
+                static bool live;
+                live = !live;
+                event_log_stream(live);
+            }
+#endif
+            return false;
+        case PARTNER:
+#ifdef TAP_DANCE_OVERRIDES
+            td_override_partner(record->event.pressed);
+#endif
+            return false;
+    }
+    return true;
+}
+
+void post_process_record_user(uint16_t keycode, keyrecord_t *record) {
+    tap_hold_record(keycode, record);
+#ifdef LATENCY_ENABLE
+    latency_record(keycode, record);
+#endif
+#ifdef EVENT_LOG_ENABLE
+    event_log_report();
+#endif
+}
+
+layer_state_t layer_state_set_user(layer_state_t state) {
+    state = update_tri_layer_state(state, NAVIGATION, MEDIA, POINTER);
+#ifdef KEYCODE_CACHE
+    keycode_cache_invalidate(state | default_layer_state);
+#endif
+    return state;
+}
+
+#ifdef KEYCODE_CACHE
+
+layer_state_t default_layer_state_set_user(layer_state_t state) {
+    keycode_cache_invalidate(layer_state | state);
+    return state;
+}
+#endif
+
+void keyboard_post_init_user(void) {
+    tuning_init();
+    tap_hold_init();
+#ifdef SPLIT_TIME_ENABLE
+    split_time_init();
+#endif
+#ifdef SCAN_PROFILE_ENABLE
+    profile_init();
+#endif
+#ifdef SCAN_SCHEDULER_ENABLE
+    scan_sched_init();
+#endif
+}
+
+#if defined(SPLIT_TIME_ENABLE) || defined(SCAN_PROFILE_ENABLE)
+// Runs once the primary half has the other half's matrix, right before the key events are processed.
+void matrix_scan_user(void) {
+#    ifdef SPLIT_TIME_ENABLE
+    split_time_task();
+#    endif
+#    ifdef SCAN_PROFILE_ENABLE
+    profile_stage(PROFILE_PROCESSING);
+#    endif
+}
+#endif
+
+void housekeeping_task_user(void) {
+#ifdef SCAN_PROFILE_ENABLE
+    profile_stage(PROFILE_HOUSEKEEPING);
+#endif
+    tap_hold_task();
+    pointer_task();
+#ifdef EVENT_LOG_ENABLE
+    event_log_task();
+#endif
+#ifdef SCAN_SCHEDULER_ENABLE
+    scan_sched_task();
+#endif
+#ifdef SCAN_PROFILE_ENABLE
+    profile_stage(PROFILE_SCAN);
+#endif
+}
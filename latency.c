@@ -0,0 +1,112 @@
+#include QMK_KEYBOARD_H
+
+#include "histogram.h"
+#include "latency.h"
+
+// Names of td_state_t, in enum order.
+static const char *const dance_states[] = {
+    "none", "unknown", "single-tap", "single-hold", "double-tap", "double-hold", "double-single-tap", "triple-tap", "triple-hold",
+};
+
+enum latency_classes {
+    LATENCY_PLAIN,
+    LATENCY_MOD_TAP,
+    LATENCY_LAYER_TAP,
+    LATENCY_DANCE, // One class per td_state_t from here
+    LATENCY_CLASS_COUNT = LATENCY_DANCE + ARRAY_SIZE(dance_states)
+};
+
+static const char *const class_names[] = {"plain", "mod-tap", "layer-tap"};
+
+_Static_assert(ARRAY_SIZE(class_names) == LATENCY_DANCE, "Every key class needs a name");
+
+static const char *latency_class_name(uint8_t class) {
+    return class < LATENCY_DANCE ? class_names[class] : dance_states[class - LATENCY_DANCE];
+}
+
+#ifdef LATENCY_HISTOGRAM_ENABLE
+typedef struct {
+    uint16_t max;
+    uint32_t total;
+    uint16_t count;
+    uint16_t buckets[LATENCY_BUCKETS];
+} latency_stats_t;
+
+static latency_stats_t stats[LATENCY_CLASS_COUNT];
+
+// Upper bound of a percentile, the last bucket has no end but the worst case is known.
+static unsigned long latency_bound(latency_stats_t *class_stats, uint8_t bucket) {
+    if (bucket == LATENCY_BUCKETS - 1) return class_stats->max + 1UL;
+    return MIN(histogram_bucket_end(bucket), class_stats->max + 1UL);
+}
+#endif
+
+static void latency_add(uint8_t class, uint16_t ms) {
+#ifdef LATENCY_HISTOGRAM_ENABLE
+    latency_stats_t *class_stats = &stats[class];
+    if (class_stats->count < UINT16_MAX) {
+        class_stats->max = MAX(class_stats->max, ms);
+        class_stats->total += ms;
+        class_stats->count++;
+        class_stats->buckets[MIN(histogram_bucket(ms), LATENCY_BUCKETS - 1)]++;
+    }
+#endif
+}
+
+void latency_record(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) return;
+
+    uint8_t class;
+    if (IS_QK_TAP_DANCE(keycode)) {
+        // Reported by the tap dance engine once the dance resolves.
+        return;
+    } else if (IS_QK_MOD_TAP(keycode)) {
+        class = LATENCY_MOD_TAP;
+    } else if (IS_QK_LAYER_TAP(keycode)) {
+        class = LATENCY_LAYER_TAP;
+    } else {
+        class = LATENCY_PLAIN;
+    }
+    uint16_t ms = TIMER_DIFF_16(timer_read(), record->event.time);
+    latency_add(class, ms);
+#ifdef LATENCY_TRACE_ENABLE
+    uprintf("lat %s 0x%04X %u\n", latency_class_name(class), keycode, ms);
+#endif
+}
+
+void latency_record_dance(uint8_t dance, uint8_t state, uint16_t elapsed) {
+    if (state >= ARRAY_SIZE(dance_states)) state = 1; // unknown
+    latency_add(LATENCY_DANCE + state, elapsed);
+#ifdef LATENCY_TRACE_ENABLE
+    uprintf("lat td %u %s %u\n", dance, dance_states[state], elapsed);
+#endif
+}
+
+#ifdef LATENCY_HISTOGRAM_ENABLE
+void latency_print(void) {
+    for (uint8_t i = 0; i < LATENCY_CLASS_COUNT; i++) {
+        latency_stats_t *class_stats = &stats[i];
+        if (!class_stats->count) continue;
+
+        uint8_t p50 = histogram_percentile(class_stats->buckets, LATENCY_BUCKETS, class_stats->count, 50);
+        uint8_t p99 = histogram_percentile(class_stats->buckets, LATENCY_BUCKETS, class_stats->count, 99);
+        uprintf("lat %s: %u presses, avg %lu p50 <%lu p99 <%lu max %u ms\n", latency_class_name(i), class_stats->count, (unsigned long)(class_stats->total / class_stats->count), latency_bound(class_stats, p50), latency_bound(class_stats, p99), class_stats->max);
+
+        // The histogram itself, as "<end ms:presses" for the buckets in use.
+        uprintf("lat %s:", latency_class_name(i));
+        for (uint8_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+            if (!class_stats->buckets[bucket]) continue;
+            if (bucket == LATENCY_BUCKETS - 1) {
+                uprintf(" >=%lu:%u", (unsigned long)histogram_bucket_end(bucket - 1), class_stats->buckets[bucket]);
+            } else {
+                uprintf(" <%lu:%u", (unsigned long)histogram_bucket_end(bucket), class_stats->buckets[bucket]);
+            }
+        }
+        uprintf("\n");
+    }
+}
+
+void latency_reset(void) {
+    memset(stats, 0, sizeof(stats));
+}
+#endif
@@ -0,0 +1,32 @@
+#ifndef FERRIS_SWEEP_LATENCY_H
+#define FERRIS_SWEEP_LATENCY_H
+
+/* Keypress-to-first-report latency, by key class.
+ *
+ * Plain keys, mod-taps and layer-taps are measured from the press event to the
+ * moment QMK is done processing it, which includes any tapping term wait.
+ * Tap dances are measured from their first press to the tier being sent, once per
+ * dance: a TD_SPECULATE single tap that was right counts as sent on the press. Each
+ * tier is a class of its own, so the tapping term waits in cur_dance() show apart
+ * from the tiers that resolve early.
+ *
+ * LATENCY_TRACE_ENABLE prints every key on the console. LATENCY_HISTOGRAM_ENABLE
+ * keeps a half-octave histogram per class instead, in fixed memory, printed by the
+ * STATS key along with the average, median, 99th percentile and worst case.
+ * Shift+STATS prints them and starts over.
+ */
+
+#ifndef LATENCY_BUCKETS
+// Half-octave buckets in ms, see histogram.h, the last one holds everything from 768 ms up
+#    define LATENCY_BUCKETS 20
+#endif
+
+void latency_record(uint16_t keycode, keyrecord_t *record);
+void latency_record_dance(uint8_t dance, uint8_t state, uint16_t elapsed);
+
+#ifdef LATENCY_HISTOGRAM_ENABLE
+void latency_print(void);
+void latency_reset(void);
+#endif
+
+#endif
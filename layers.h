@@ -0,0 +1,17 @@
+#ifndef FERRIS_SWEEP_LAYERS_H
+#define FERRIS_SWEEP_LAYERS_H
+
+enum layer_names {
+    BASE,
+    SYMBOL,
+    NAVIGATION,
+    // Sparse layers, stored in sparse_layers[] instead of keymaps[]
+    FUNCTION,
+    MEDIA,
+    POINTER, // NAVIGATION and MEDIA held together
+    LAYER_COUNT
+};
+
+#define FIRST_SPARSE_LAYER FUNCTION
+
+#endif
@@ -0,0 +1,121 @@
+#include QMK_KEYBOARD_H
+
+#include "pointer.h"
+#include "tuning.h"
+
+enum pointer_axes { AXIS_X, AXIS_Y, AXIS_V, AXIS_H, AXIS_COUNT };
+
+// First tuning parameter of each axis' curve, its fields follow in the order of curve_fields
+static const uint8_t curves[AXIS_COUNT] PROGMEM = {
+    [AXIS_X] = TUNING_POINTER_START_SPEED,
+    [AXIS_Y] = TUNING_POINTER_START_SPEED,
+    [AXIS_V] = TUNING_WHEEL_START_SPEED,
+    [AXIS_H] = TUNING_WHEEL_START_SPEED,
+};
+
+enum curve_fields { CURVE_START, CURVE_ACCEL, CURVE_MAX, CURVE_FRICTION, CURVE_STOP };
+
+#define CURVE_IN_ORDER(prefix)                                                                                                              \
+    (TUNING_##prefix##_ACCEL - TUNING_##prefix##_START_SPEED == CURVE_ACCEL && TUNING_##prefix##_MAX_SPEED - TUNING_##prefix##_START_SPEED == CURVE_MAX && \
+     TUNING_##prefix##_FRICTION - TUNING_##prefix##_START_SPEED == CURVE_FRICTION && TUNING_##prefix##_STOP_SPEED - TUNING_##prefix##_START_SPEED == CURVE_STOP)
+
+_Static_assert(CURVE_IN_ORDER(POINTER) && CURVE_IN_ORDER(WHEEL), "The pointer and wheel parameters have to follow the order of curve_fields");
+
+static uint16_t curve(uint8_t axis, uint8_t field) {
+    return tuning[pgm_read_byte(&curves[axis]) + field];
+}
+
+// Held keys per axis, bit 0 for the negative direction and bit 1 for the positive one
+static uint8_t  held[AXIS_COUNT];
+static int16_t  velocity[AXIS_COUNT];  // 1/256 units per frame
+static int16_t  remainder[AXIS_COUNT]; // Sub-unit movement carried to the next frame
+static uint16_t next_frame;
+static bool     moving;
+
+static int8_t direction(uint8_t axis) {
+    return (held[axis] >> 1) - (held[axis] & 1);
+}
+
+static void pointer_axis_frame(uint8_t axis, int8_t *out) {
+    int16_t speed = velocity[axis];
+    int8_t  dir   = direction(axis);
+
+    if (dir) {
+        int16_t start = curve(axis, CURVE_START);
+        int16_t max   = curve(axis, CURVE_MAX);
+        // A fresh press, or one against the current motion, starts over at the start speed.
+        if (speed == 0 || (speed > 0) != (dir > 0)) {
+            speed = dir * start;
+        } else {
+            // Speeds are capped at 32511 by the tuning table, so a frame moves at most 127 units.
+            int32_t faster = speed + dir * (int32_t)curve(axis, CURVE_ACCEL);
+            speed          = faster > max ? max : faster < -max ? -max : faster;
+        }
+    } else if (speed) {
+        int16_t stop = curve(axis, CURVE_STOP);
+        speed -= (int16_t)((int32_t)speed * curve(axis, CURVE_FRICTION) / 256);
+        if (speed < stop && speed > -stop) speed = 0;
+    }
+    velocity[axis] = speed;
+
+    int16_t position  = remainder[axis] + speed;
+    int8_t  units     = position / 256;
+    remainder[axis]   = speed ? position - units * 256 : 0;
+    *out              = units;
+}
+
+static void pointer_frame(void) {
+    int8_t units[AXIS_COUNT];
+    moving = false;
+    for (uint8_t axis = 0; axis < AXIS_COUNT; axis++) {
+        pointer_axis_frame(axis, &units[axis]);
+        if (velocity[axis] || held[axis]) moving = true;
+    }
+    if (!units[AXIS_X] && !units[AXIS_Y] && !units[AXIS_V] && !units[AXIS_H]) return;
+
+    report_mouse_t report = {0};
+    report.buttons        = mousekey_get_report().buttons;
+    report.x              = units[AXIS_X];
+    report.y              = units[AXIS_Y];
+    report.v              = units[AXIS_V];
+    report.h              = units[AXIS_H];
+    host_mouse_send(&report);
+}
+
+bool pointer_process_record(uint16_t keycode, keyrecord_t *record) {
+    uint8_t axis, bit;
+    switch (keycode) {
+        // clang-format off
+        case KC_MS_L: axis = AXIS_X; bit = 1; break;
+        case KC_MS_R: axis = AXIS_X; bit = 2; break;
+        case KC_MS_U: axis = AXIS_Y; bit = 1; break;
+        case KC_MS_D: axis = AXIS_Y; bit = 2; break;
+        case KC_WH_D: axis = AXIS_V; bit = 1; break;
+        case KC_WH_U: axis = AXIS_V; bit = 2; break;
+        case KC_WH_L: axis = AXIS_H; bit = 1; break;
+        case KC_WH_R: axis = AXIS_H; bit = 2; break;
+        // clang-format on
+        default:
+            return true;
+    }
+    if (record->event.pressed) {
+        held[axis] |= bit;
+        // From rest, move on the press itself and count the following frames from here.
+        // Otherwise the next frame picks the key up, so other axes do not get an extra one.
+        if (!moving) {
+            pointer_frame();
+            next_frame = timer_read() + tuning[TUNING_POINTER_FRAME_MS];
+        }
+    } else {
+        held[axis] &= ~bit;
+    }
+    return false;
+}
+
+void pointer_task(void) {
+    if (!moving || TIMER_DIFF_16(timer_read(), next_frame) >= 0x8000) return;
+    next_frame += tuning[TUNING_POINTER_FRAME_MS];
+    // After a long stall, restart the frame clock rather than catching up in a burst.
+    if (TIMER_DIFF_16(timer_read(), next_frame) < 0x8000) next_frame = timer_read() + tuning[TUNING_POINTER_FRAME_MS];
+    pointer_frame();
+}
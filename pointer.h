@@ -0,0 +1,54 @@
+#ifndef FERRIS_SWEEP_POINTER_H
+#define FERRIS_SWEEP_POINTER_H
+
+/* Kinetic cursor and wheel for the KC_MS_* and KC_WH_* keys.
+ *
+ * Each axis keeps a fixed-point velocity in 1/256 px (or wheel steps) per frame. A
+ * held key starts it at the start speed and adds the acceleration every frame up to
+ * the max speed. Once released, friction takes a share of it every frame until it
+ * drops below the stop speed, which gives the wheel its momentum. Frames run every
+ * POINTER_FRAME_MS, and a frame that moves nothing sends no report.
+ *
+ * tools/pointer_curves.py plots the resulting curves from the values in config.h.
+ * They are only defaults, tools/tuning.py changes them at run time, see tuning.h.
+ */
+
+#ifndef POINTER_FRAME_MS
+#    define POINTER_FRAME_MS 16
+#endif
+#ifndef POINTER_START_SPEED
+#    define POINTER_START_SPEED 512
+#endif
+#ifndef POINTER_ACCEL
+#    define POINTER_ACCEL 96
+#endif
+#ifndef POINTER_MAX_SPEED
+#    define POINTER_MAX_SPEED 5120
+#endif
+#ifndef POINTER_FRICTION
+#    define POINTER_FRICTION 96
+#endif
+#ifndef POINTER_STOP_SPEED
+#    define POINTER_STOP_SPEED 64
+#endif
+#ifndef WHEEL_START_SPEED
+#    define WHEEL_START_SPEED 32
+#endif
+#ifndef WHEEL_ACCEL
+#    define WHEEL_ACCEL 4
+#endif
+#ifndef WHEEL_MAX_SPEED
+#    define WHEEL_MAX_SPEED 192
+#endif
+#ifndef WHEEL_FRICTION
+#    define WHEEL_FRICTION 16
+#endif
+#ifndef WHEEL_STOP_SPEED
+#    define WHEEL_STOP_SPEED 16
+#endif
+
+// Call from process_record_user(), returns false for the keys handled here.
+bool pointer_process_record(uint16_t keycode, keyrecord_t *record);
+void pointer_task(void);
+
+#endif
@@ -0,0 +1,93 @@
+#include QMK_KEYBOARD_H
+
+#include "histogram.h"
+#include "profile.h"
+
+// Half-octave buckets in µs, see histogram.h, the last one ends at 64 ms
+#define PROFILE_BUCKETS 32
+
+typedef struct {
+    uint16_t min;
+    uint32_t total;
+    uint16_t count;
+    uint16_t buckets[PROFILE_BUCKETS];
+} profile_stats_t;
+
+static profile_stats_t stats[PROFILE_STAGE_COUNT];
+static uint8_t         current = PROFILE_SCAN;
+static uint16_t        started;
+static uint32_t        window_start;
+
+static const char *const stage_names[] = {"scan", "debounce", "transport", "processing", "housekeeping"};
+
+_Static_assert(ARRAY_SIZE(stage_names) == PROFILE_STAGE_COUNT, "Every profile stage needs a name");
+
+#if defined(__AVR__)
+// Timer1 runs free at F_CPU / 8, nothing else in this keymap uses it
+static void profile_clock_init(void) {
+    TCCR1A = 0;
+    TCCR1B = _BV(CS11);
+}
+
+static uint16_t profile_clock(void) {
+    return TCNT1;
+}
+
+static uint16_t profile_us(uint16_t ticks) {
+    return ticks / (F_CPU / 8 / 1000000);
+}
+#elif defined(PROTOCOL_CHIBIOS)
+static void profile_clock_init(void) {}
+
+static uint16_t profile_clock(void) {
+    return chVTGetSystemTimeX();
+}
+
+static uint16_t profile_us(uint16_t ticks) {
+    return TIME_I2US(ticks);
+}
+#else
+#    error "No profile clock for this platform"
+#endif
+
+void profile_init(void) {
+    profile_clock_init();
+    started      = profile_clock();
+    window_start = timer_read32();
+    for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        stats[i].min = UINT16_MAX;
+    }
+}
+
+void profile_stage(uint8_t stage) {
+    uint16_t now = profile_clock();
+    uint16_t us  = profile_us(now - started);
+    started      = now;
+
+    profile_stats_t *stage_stats = &stats[current];
+    if (stage_stats->count < UINT16_MAX) {
+        stage_stats->min = MIN(stage_stats->min, us);
+        stage_stats->total += us;
+        stage_stats->count++;
+        stage_stats->buckets[histogram_bucket(us)]++;
+    }
+    current = stage;
+}
+
+void profile_print(void) {
+    uint32_t elapsed = timer_elapsed32(window_start);
+    // Every loop goes through housekeeping exactly once.
+    uint16_t scans = stats[PROFILE_HOUSEKEEPING].count;
+    uprintf("prof: %lu scans/s\n", elapsed ? (unsigned long)scans * 1000 / elapsed : 0);
+
+    for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        profile_stats_t *stage_stats = &stats[i];
+        if (!stage_stats->count) continue;
+
+        uint8_t p99 = histogram_percentile(stage_stats->buckets, PROFILE_BUCKETS, stage_stats->count, 99);
+        uprintf("prof %s: min %u avg %lu p99 <%lu us\n", stage_names[i], stage_stats->min, (unsigned long)(stage_stats->total / stage_stats->count), (unsigned long)histogram_bucket_end(p99));
+        memset(stage_stats, 0, sizeof(*stage_stats));
+        stage_stats->min = UINT16_MAX;
+    }
+    window_start = timer_read32();
+}
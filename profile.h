@@ -0,0 +1,27 @@
+#ifndef FERRIS_SWEEP_PROFILE_H
+#define FERRIS_SWEEP_PROFILE_H
+
+/* Time spent in each stage of the main loop, printed on the console by the STATS key.
+ *
+ * The loop is split at the points the keymap can see: the custom debounce, the end
+ * of the split transport (matrix_scan_user) and housekeeping. Each call to
+ * profile_stage() closes the running stage and starts the next one. For every stage
+ * the minimum, average and 99th percentile since the last print are reported, along
+ * with the scan rate. Durations come from a free running timer, Timer1 at 0.5 µs on
+ * AVR and the system time on ChibiOS, whose resolution is CH_CFG_ST_FREQUENCY.
+ */
+
+enum profile_stages {
+    PROFILE_SCAN,         // Reading the matrix, and the USB stack between two loops
+    PROFILE_DEBOUNCE,     // debounce.c
+    PROFILE_TRANSPORT,    // Split transport, the primary half fetching the other one
+    PROFILE_PROCESSING,   // Key events through tap_hold.c and tap_dance.c, and QMK's own tasks
+    PROFILE_HOUSEKEEPING, // housekeeping_task_user()
+    PROFILE_STAGE_COUNT
+};
+
+void profile_init(void);
+void profile_stage(uint8_t stage);
+void profile_print(void);
+
+#endif
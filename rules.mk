@@ -1,3 +1,64 @@
 TAP_DANCE_ENABLE = yes
+MOUSEKEY_ENABLE = yes
+# Eager press, deferred release, chosen per key in keymap.c
+DEBOUNCE_TYPE = custom
+# Print keypress-to-first-report latency on the console
+LATENCY_TRACE_ENABLE = no
+# Keep a keypress-to-first-report latency histogram per key class, printed on the console by the STATS key.
+# About 600 bytes of RAM, and it turns the console on
+LATENCY_HISTOGRAM_ENABLE = yes
+# Keep the last key events and reports in RAM, dumped on the console by the STATS key
+EVENT_LOG_ENABLE = no
+# Stamp the secondary half's keys with the time they were scanned there, not when they reached the primary half
+SPLIT_TIME_ENABLE = yes
+# Get and set the timing parameters in tuning.h over raw HID with tools/tuning.py, and keep them in EEPROM
+TUNING_ENABLE = yes
+# Sleep between scans after a second without activity, ChibiOS only, see scan_sched.h
+SCAN_SCHEDULER_ENABLE = no
+# Time each stage of the main loop, printed on the console by the STATS key
+SCAN_PROFILE_ENABLE = no
 
-SRC += tap_dance.c
+SRC += debounce.c pointer.c sparse_layers.c tap_dance.c tap_hold.c tuning.c
+
+ifeq ($(strip $(LATENCY_TRACE_ENABLE)), yes)
+    OPT_DEFS += -DLATENCY_TRACE_ENABLE
+    LATENCY_ENABLE = yes
+endif
+
+ifeq ($(strip $(LATENCY_HISTOGRAM_ENABLE)), yes)
+    OPT_DEFS += -DLATENCY_HISTOGRAM_ENABLE
+    LATENCY_ENABLE = yes
+endif
+
+ifeq ($(strip $(LATENCY_ENABLE)), yes)
+    CONSOLE_ENABLE = yes
+    OPT_DEFS += -DLATENCY_ENABLE
+    SRC += latency.c
+endif
+
+ifeq ($(strip $(EVENT_LOG_ENABLE)), yes)
+    CONSOLE_ENABLE = yes
+    OPT_DEFS += -DEVENT_LOG_ENABLE
+    SRC += event_log.c
+endif
+
+ifeq ($(strip $(SPLIT_TIME_ENABLE)), yes)
+    OPT_DEFS += -DSPLIT_TIME_ENABLE -DSPLIT_TRANSACTION_IDS_USER=RPC_ID_USER_SPLIT_TIME
+    SRC += split_time.c
+endif
+
+ifeq ($(strip $(TUNING_ENABLE)), yes)
+    RAW_ENABLE = yes
+    OPT_DEFS += -DTUNING_ENABLE
+endif
+
+ifeq ($(strip $(SCAN_SCHEDULER_ENABLE)), yes)
+    OPT_DEFS += -DSCAN_SCHEDULER_ENABLE
+    SRC += scan_sched.c
+endif
+
+ifeq ($(strip $(SCAN_PROFILE_ENABLE)), yes)
+    CONSOLE_ENABLE = yes
+    OPT_DEFS += -DSCAN_PROFILE_ENABLE
+    SRC += profile.c
+endif
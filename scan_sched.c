@@ -0,0 +1,87 @@
+#include QMK_KEYBOARD_H
+
+#include "scan_sched.h"
+#include "tap_hold.h"
+
+#if defined(__AVR__)
+#    error "SCAN_SCHEDULER_ENABLE needs an MCU that can sleep until a key pin changes, an AVR wait only spins"
+#endif
+
+_Static_assert(SCAN_IDLE_TIME > TAPPING_TERM_MAX, "SCAN_IDLE_TIME has to outlast the longest tapping term");
+
+static bool idle;
+
+static struct {
+    uint32_t active_loops;
+    uint32_t idle_loops;
+    uint16_t wakes; // Returns to full rate after being idle
+} sched_stats;
+
+#ifdef PROTOCOL_CHIBIOS
+/* Every key of the Sweep has a pin of its own. Each edge on one signals key_edge, which
+ * the sleep waits on. An edge from before the sleep, already scanned, only makes the
+ * next sleep return at once.
+ */
+static const pin_t key_pins[MATRIX_ROWS / 2][MATRIX_COLS] = DIRECT_PINS;
+#    ifdef DIRECT_PINS_RIGHT
+static const pin_t key_pins_right[MATRIX_ROWS / 2][MATRIX_COLS] = DIRECT_PINS_RIGHT;
+#    endif
+
+static binary_semaphore_t key_edge;
+
+static void key_edge_callback(void *arg) {
+    chSysLockFromISR();
+    chBSemSignalI(&key_edge);
+    chSysUnlockFromISR();
+}
+
+void scan_sched_init(void) {
+    const pin_t(*pins)[MATRIX_COLS] = key_pins;
+#    ifdef DIRECT_PINS_RIGHT
+    if (!is_keyboard_left()) pins = key_pins_right;
+#    endif
+    chBSemObjectInit(&key_edge, true);
+    for (uint8_t row = 0; row < MATRIX_ROWS / 2; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (pins[row][col] == NO_PIN) continue;
+            palSetLineCallback(pins[row][col], key_edge_callback, NULL);
+            palEnableLineEvent(pins[row][col], PAL_EVENT_MODE_BOTH_EDGES);
+        }
+    }
+}
+
+void scan_sched_sleep(uint16_t timeout) {
+    chBSemWaitTimeout(&key_edge, TIME_MS2I(timeout));
+}
+#else
+void scan_sched_init(void) {}
+#endif
+
+static bool keys_down(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (matrix_get_row(row)) return true;
+    }
+    return false;
+}
+
+void scan_sched_task(void) {
+    /* Key events on this half count as activity, and on the other half too: the primary
+     * half gets the secondary's matrix, and SPLIT_ACTIVITY_ENABLE hands the primary's
+     * activity to the secondary. A held key makes no events, so it counts as well.
+     */
+    if (keys_down() || last_input_activity_elapsed() < SCAN_IDLE_TIME) {
+        if (idle) {
+            idle = false;
+            sched_stats.wakes++;
+        }
+        sched_stats.active_loops++;
+        return;
+    }
+    idle = true;
+    sched_stats.idle_loops++;
+    scan_sched_sleep(SCAN_IDLE_INTERVAL);
+}
+
+void scan_sched_print_stats(void) {
+    uprintf("sched: %lu active loops, %lu idle loops, %u wakes\n", (unsigned long)sched_stats.active_loops, (unsigned long)sched_stats.idle_loops, sched_stats.wakes);
+}
@@ -0,0 +1,35 @@
+#ifndef FERRIS_SWEEP_SCAN_SCHED_H
+#define FERRIS_SWEEP_SCAN_SCHED_H
+
+/* Scan at full rate while the keyboard is in use, and sleep between scans once nothing
+ * happened on either half for SCAN_IDLE_TIME ms.
+ *
+ * The sleep ends after SCAN_IDLE_INTERVAL ms or as soon as one of this half's key pins
+ * changes, so a press on the half that is asleep is scanned right away. The primary half
+ * cannot see the pins of the secondary one, it only finds their presses on its next scan
+ * of the link: those wait up to SCAN_IDLE_INTERVAL ms, the first one after a quiet spell.
+ * Every tapping term, tap dance timeout and pointer glide runs out well within the active
+ * window, so none of their deadlines is ever stretched by the idle sleep.
+ *
+ * Sleeping takes ChibiOS: an AVR wait only spins and saves nothing, so the scheduler does
+ * not build there. tests/bench_scan_sched.c has the latency and sleep time it comes to.
+ */
+
+#include <stdint.h>
+
+#ifndef SCAN_IDLE_TIME
+#    define SCAN_IDLE_TIME 1000
+#endif
+#ifndef SCAN_IDLE_INTERVAL
+#    define SCAN_IDLE_INTERVAL 1
+#endif
+
+// Call from keyboard_post_init_user().
+void scan_sched_init(void);
+// Call last in housekeeping_task_user(), it sleeps there when idle.
+void scan_sched_task(void);
+void scan_sched_print_stats(void);
+// Sleep for timeout ms, or until a key pin of this half changes. The host harness brings its own.
+void scan_sched_sleep(uint16_t timeout);
+
+#endif
@@ -0,0 +1,62 @@
+#include QMK_KEYBOARD_H
+
+#include "layers.h"
+#include "sparse_layers.h"
+
+// Layout position + 1 of each matrix position, 0 where the matrix has no key.
+#define P(position) (POS_##position + 1)
+static const uint8_t layout_index[MATRIX_ROWS][MATRIX_COLS] PROGMEM = LAYOUT_split_3x5_2(
+    P(L11), P(L12), P(L13), P(L14), P(L15), P(R11), P(R12), P(R13), P(R14), P(R15),
+    P(L21), P(L22), P(L23), P(L24), P(L25), P(R21), P(R22), P(R23), P(R24), P(R25),
+    P(L31), P(L32), P(L33), P(L34), P(L35), P(R31), P(R32), P(R33), P(R34), P(R35),
+                                    P(L41), P(L42), P(R41), P(R42)
+);
+#undef P
+
+static uint16_t sparse_keycode(const sparse_layer_t *layer, uint8_t row, uint8_t column) {
+    uint8_t index = pgm_read_byte(&layout_index[row][column]);
+    if (!index--) return KC_NO;
+
+    uint8_t byte = pgm_read_byte(&layer->bitmap[index / 8]);
+    uint8_t bit  = 1 << (index % 8);
+    if (!(byte & bit)) return KC_NO;
+
+    const uint16_t *keycodes = pgm_read_ptr(&layer->keycodes);
+    return pgm_read_word(&keycodes[pgm_read_byte(&layer->before[index / 8]) + __builtin_popcount(byte & (bit - 1))]);
+}
+
+#ifdef KEYCODE_CACHE
+// Keycodes of the highest active layer, each filled in the first time it is looked up
+static uint16_t     cache[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t cache_valid[MATRIX_ROWS];
+static uint8_t      cache_layer;
+
+void keycode_cache_invalidate(layer_state_t layers) {
+    uint8_t layer = get_highest_layer(layers);
+    if (layer == cache_layer) return;
+    cache_layer = layer;
+    memset(cache_valid, 0, sizeof(cache_valid));
+}
+#endif
+
+// Replaces QMK's lookup, which only knows about keymaps[].
+uint16_t keycode_at_keymap_location(uint8_t layer_num, uint8_t row, uint8_t column) {
+    if (row >= MATRIX_ROWS || column >= MATRIX_COLS) return KC_NO;
+    // A dense layer already is a single read, the cache would only add to it.
+    if (layer_num < FIRST_SPARSE_LAYER) return pgm_read_word(&keymaps[layer_num][row][column]);
+    if (layer_num >= LAYER_COUNT) return KC_TRNS;
+
+    const sparse_layer_t *layer = &sparse_layers[layer_num - FIRST_SPARSE_LAYER];
+#ifdef KEYCODE_CACHE
+    // QMK asks for the highest active layer first, lower ones only past a KC_TRNS.
+    if (layer_num == cache_layer) {
+        matrix_row_t bit = (matrix_row_t)1 << column;
+        if (!(cache_valid[row] & bit)) {
+            cache[row][column] = sparse_keycode(layer, row, column);
+            cache_valid[row] |= bit;
+        }
+        return cache[row][column];
+    }
+#endif
+    return sparse_keycode(layer, row, column);
+}
@@ -0,0 +1,63 @@
+#ifndef FERRIS_SWEEP_SPARSE_LAYERS_H
+#define FERRIS_SWEEP_SPARSE_LAYERS_H
+
+/* Compact storage for layers that are mostly XXXXXXX.
+ *
+ * A sparse layer lists only the keys it uses, as X(position, keycode) entries in
+ * layout order: L11..L15, R11..R15, L21.., R35, L41, L42, R41, R42. It is stored as a
+ * bitmap of the layout positions in use plus the keycodes of just those positions.
+ * Looking a key up is a bitmap byte read, one popcount and one keycode read.
+ *
+ * Sparse layers come after the dense ones in the layer enum, keymaps[] only holds
+ * the dense layers. Every other position of a sparse layer is KC_NO, so a key that
+ * should fall through to the layers below, like a thumb that turns on another layer,
+ * needs an explicit KC_TRNS entry.
+ */
+
+// Positions of LAYOUT_split_3x5_2, in the order the macro takes them.
+enum layout_positions {
+    POS_L11, POS_L12, POS_L13, POS_L14, POS_L15, POS_R11, POS_R12, POS_R13, POS_R14, POS_R15,
+    POS_L21, POS_L22, POS_L23, POS_L24, POS_L25, POS_R21, POS_R22, POS_R23, POS_R24, POS_R25,
+    POS_L31, POS_L32, POS_L33, POS_L34, POS_L35, POS_R31, POS_R32, POS_R33, POS_R34, POS_R35,
+    POS_L41, POS_L42, POS_R41, POS_R42,
+    LAYOUT_KEY_COUNT
+};
+
+#define SPARSE_LAYER_BYTES ((LAYOUT_KEY_COUNT + 7) / 8)
+
+typedef struct {
+    uint8_t         bitmap[SPARSE_LAYER_BYTES]; // Bit n is set when layout position n has a keycode
+    uint8_t         before[SPARSE_LAYER_BYTES]; // Keycodes stored for the positions of the bytes before this one
+    const uint16_t *keycodes;                   // In layout order, in PROGMEM
+} sparse_layer_t;
+
+#define SPARSE_KEY_BIT(position, keycode) | ((uint64_t)1 << POS_##position)
+#define SPARSE_KEY_KEYCODE(position, keycode) keycode,
+
+#define SPARSE_LAYER_BITS(keys) (0 keys(SPARSE_KEY_BIT))
+#define SPARSE_LAYER_BYTE(keys, i) (uint8_t)(SPARSE_LAYER_BITS(keys) >> (8 * (i)))
+#define SPARSE_LAYER_BEFORE(keys, i) __builtin_popcountll(SPARSE_LAYER_BITS(keys) & (((uint64_t)1 << (8 * (i))) - 1))
+
+// Define the keycode list of a sparse layer, name##_keycodes.
+#define SPARSE_LAYER_KEYCODES(name, keys) static const uint16_t name##_keycodes[] PROGMEM = {keys(SPARSE_KEY_KEYCODE)};
+
+// Initializer for the sparse_layers[] entry of a layer, after SPARSE_LAYER_KEYCODES.
+#define SPARSE_LAYER(name, keys) \
+    { \
+        .bitmap   = {SPARSE_LAYER_BYTE(keys, 0), SPARSE_LAYER_BYTE(keys, 1), SPARSE_LAYER_BYTE(keys, 2), SPARSE_LAYER_BYTE(keys, 3), SPARSE_LAYER_BYTE(keys, 4)}, \
+        .before   = {SPARSE_LAYER_BEFORE(keys, 0), SPARSE_LAYER_BEFORE(keys, 1), SPARSE_LAYER_BEFORE(keys, 2), SPARSE_LAYER_BEFORE(keys, 3), SPARSE_LAYER_BEFORE(keys, 4)}, \
+        .keycodes = name##_keycodes, \
+    }
+
+_Static_assert(SPARSE_LAYER_BYTES == 5, "SPARSE_LAYER() spells out one initializer per bitmap byte");
+
+// Defined in keymap.c, one per layer from FIRST_SPARSE_LAYER on.
+extern const sparse_layer_t sparse_layers[];
+
+/* With KEYCODE_CACHE, lookups on a sparse layer that is the highest active one are
+ * kept in RAM, so repeated lookups are a single array read. Call this with the new
+ * layer_state | default_layer_state whenever either changes.
+ */
+void keycode_cache_invalidate(layer_state_t layers);
+
+#endif
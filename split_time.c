@@ -0,0 +1,113 @@
+#include <string.h>
+
+#include QMK_KEYBOARD_H
+
+#include "transactions.h"
+#include "split_time.h"
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+
+typedef struct {
+    uint16_t time;
+    bool     pressed;
+} split_time_stamp_t;
+
+// Secondary half: last change of each of its keys, in sync_timer time
+static split_time_stamp_t stamps[ROWS_PER_HAND][MATRIX_COLS];
+static matrix_row_t       previous[ROWS_PER_HAND];
+
+// Primary half: the secondary matrix as of the last sync, and the stamps fetched for the keys that changed in it
+static matrix_row_t       synced[ROWS_PER_HAND];
+static split_time_stamp_t fetched[ROWS_PER_HAND][MATRIX_COLS];
+static matrix_row_t       fetched_keys[ROWS_PER_HAND];
+
+// Primary half: time of the last event passed on, stamps never go back past it
+static uint16_t last_event_time;
+
+// The keys the primary half asks for, their stamps come back in row and column order.
+typedef struct {
+    matrix_row_t keys[ROWS_PER_HAND];
+} split_time_request_t;
+
+static void split_time_handler(uint8_t in_len, const void *in_data, uint8_t out_len, void *out_data) {
+    const split_time_request_t *request = in_data;
+    split_time_stamp_t         *reply   = out_data;
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (request->keys[row] & ((matrix_row_t)1 << col)) *reply++ = stamps[row][col];
+        }
+    }
+}
+
+void split_time_init(void) {
+    transaction_register_rpc(RPC_ID_USER_SPLIT_TIME, split_time_handler);
+}
+
+void matrix_slave_scan_user(void) {
+    uint8_t  offset = is_keyboard_left() ? 0 : ROWS_PER_HAND;
+    uint16_t now    = sync_timer_read();
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        matrix_row_t current = matrix_get_row(offset + row);
+        matrix_row_t changes = current ^ previous[row];
+        if (!changes) continue;
+        previous[row] = current;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            matrix_row_t bit = (matrix_row_t)1 << col;
+            if (!(changes & bit)) continue;
+            stamps[row][col] = (split_time_stamp_t){.time = now, .pressed = current & bit};
+        }
+    }
+}
+
+void split_time_task(void) {
+    if (!is_keyboard_master()) return;
+
+    uint8_t              offset  = is_keyboard_left() ? ROWS_PER_HAND : 0;
+    split_time_request_t request = {0};
+    uint8_t              count   = 0;
+    memset(fetched_keys, 0, sizeof(fetched_keys));
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        matrix_row_t current = matrix_get_row(offset + row);
+        matrix_row_t changes = current ^ synced[row];
+        synced[row]          = current;
+        for (uint8_t col = 0; col < MATRIX_COLS && count < SPLIT_TIME_BATCH; col++) {
+            if (!(changes & ((matrix_row_t)1 << col))) continue;
+            request.keys[row] |= (matrix_row_t)1 << col;
+            count++;
+        }
+    }
+    if (!count) return;
+
+    // One round trip for all the keys of this sync, before QMK turns them into events.
+    split_time_stamp_t reply[SPLIT_TIME_BATCH];
+    if (!transaction_rpc_exec(RPC_ID_USER_SPLIT_TIME, sizeof(request), &request, count * sizeof(reply[0]), reply)) return;
+    uint8_t i = 0;
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (request.keys[row] & ((matrix_row_t)1 << col)) fetched[row][col] = reply[i++];
+        }
+        fetched_keys[row] = request.keys[row];
+    }
+}
+
+void split_time_correct(keyrecord_t *record) {
+    if (!is_keyboard_master()) return;
+
+    keypos_t key       = record->event.key;
+    bool     this_half = (key.row < ROWS_PER_HAND) == is_keyboard_left();
+    if (!this_half) {
+        uint8_t      row = key.row % ROWS_PER_HAND;
+        matrix_row_t bit = (matrix_row_t)1 << key.col;
+        // Events the keymap makes up itself have no fetched stamp, they keep their own time.
+        if (fetched_keys[row] & bit) {
+            fetched_keys[row] &= ~bit;
+            split_time_stamp_t stamp = fetched[row][key.col];
+            if (stamp.pressed == record->event.pressed && TIMER_DIFF_16(record->event.time, stamp.time) <= SPLIT_TIME_MAX_AGE) {
+                // Stay after the previous event, the tapping code reads a negative gap as a timeout.
+                bool after         = TIMER_DIFF_16(stamp.time, last_event_time) < 0x8000;
+                record->event.time = (after ? stamp.time : last_event_time) | 1;
+            }
+        }
+    }
+    last_event_time = record->event.time;
+}
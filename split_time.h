@@ -0,0 +1,35 @@
+#ifndef FERRIS_SWEEP_SPLIT_TIME_H
+#define FERRIS_SWEEP_SPLIT_TIME_H
+
+/* Scan-time stamps for the keys of the secondary half.
+ *
+ * A key on the secondary half reaches the primary one transport transaction after
+ * it was scanned, and QMK stamps it on arrival. The secondary half now notes the
+ * synchronized time each of its keys changed. Right after each matrix sync that
+ * changed keys of the secondary half, the primary half fetches their stamps in one
+ * transaction, and the events for those keys take them, so the tapping term and
+ * interrupt logic see when each key was really pressed. A stamp is never moved before
+ * the previous event, and it is ignored when it does not describe this event.
+ *
+ * QMK's own matrix transaction cannot carry the stamps from a keymap, hence the second
+ * one. It costs a round trip on the scans that carry a change of the other half, and
+ * none on the others.
+ */
+
+// A stamp older than this belongs to an earlier change of the key, ms
+#ifndef SPLIT_TIME_MAX_AGE
+#    define SPLIT_TIME_MAX_AGE 50
+#endif
+
+// Stamps fetched per transaction, the keys past them keep their arrival time
+#ifndef SPLIT_TIME_BATCH
+#    define SPLIT_TIME_BATCH 8
+#endif
+
+void split_time_init(void);
+// Call from matrix_scan_user(), which runs on the primary half between the sync and the events.
+void split_time_task(void);
+// Call first thing in pre_process_record_user().
+void split_time_correct(keyrecord_t *record);
+
+#endif
@@ -1,6 +1,13 @@
 #include QMK_KEYBOARD_H
 
 #include "tap_dance.h"
+#include "tap_hold.h"
+#ifdef LATENCY_ENABLE
+#    include "latency.h"
+#endif
+#ifdef EVENT_LOG_ENABLE
+#    include "event_log.h"
+#endif
 
 typedef enum {
     TD_NONE,
@@ -24,9 +31,15 @@ typedef enum {
  * Pressed: Whether or not the key is still being pressed. If this value is true, that means the tapping term
  *  has ended, but the key is still being pressed down. This generally means the key is being "held".
  *
- * One thing that is currenlty not possible with qmk software in regards to tap dance is to mimic the "permissive hold"
- *  feature. In general, advanced tap dances do not work well if they are used with commonly typed letters.
- *  For example "A". Tap dances are best used on non-letter keys that are not hit while typing letters.
+ * Permissive hold: QMK itself resolves a dance as soon as another key is pressed. With TAP_DANCE_PERMISSIVE_HOLD,
+ *  td_pre_process_record() holds that press back while the first tap of a dance with a hold tier is still down,
+ *  so a nested press and release of the other key commits 'TD_SINGLE_HOLD' right away, like PERMISSIVE_HOLD does
+ *  for mod-taps. That works because QMK calls pre_process_record_user() from action_exec(), before the tapping
+ *  code, while its own interrupt (preprocess_tap_dance()) runs from process_record(), once the press gets there.
+ *  The keycode pre_process_record_user() gets is only looked up on the layers active at that point though, so the
+ *  position of a dance key is taken in td_process_record(), where QMK runs it for the press it is about to dance.
+ *  tests/test_tap_dance.c has the cases. In general, advanced tap dances do not work well if they are used with
+ *  commonly typed letters. For example "A". Tap dances are best used on non-letter keys that are not hit while typing letters.
  *
  * Good places to put an advanced tap dance:
  *  z,q,x,j,k,v,b, any function key, home/end, comma, semi-colon
@@ -65,602 +78,347 @@ static td_state_t cur_dance(tap_dance_state_t *state) {
 }
 
 typedef struct {
-    bool is_press_action;
     td_state_t state;
+    uint16_t   keycode; // Registered by the engine, released on reset
+    uint16_t   pressed_at;
+    bool       speculated;
 } td_tap_t;
 
-static td_tap_t tap_states[] = {
-    [AMPERSAND_PIPE] = {.is_press_action = true, .state = TD_NONE},
-    [ASTERISK_CIRCLE] = {.is_press_action = true, .state = TD_NONE},
-    [BRACES] = {.is_press_action = true, .state = TD_NONE},
-    [EQUAL_PLUS] = {.is_press_action = true, .state = TD_NONE},
-    [GRAVE_TILDE] = {.is_press_action = true, .state = TD_NONE},
-    [LESSTHAN_GREATERTHAN] = {.is_press_action = true, .state = TD_NONE},
-    [PARANTHESIS] = {.is_press_action = true, .state = TD_NONE},
-    [Q_ESCAPE] = {.is_press_action = true, .state = TD_NONE},
-    [QUESTION_EXCLAMATION] = {.is_press_action = true, .state = TD_NONE},
-    [QUOTE_DOUBLEQUOTE] = {.is_press_action = true, .state = TD_NONE},
-    [SEMICOLON_COLON] = {.is_press_action = true, .state = TD_NONE},
-    [SLASH_BACKSLASH] = {.is_press_action = true, .state = TD_NONE},
-    [UNDERSCORE_MINUS] = {.is_press_action = true, .state = TD_NONE},
+typedef struct {
+    uint8_t  max_tier;
+    uint8_t  flags;
+    uint16_t single_tap;
+    uint16_t single_hold;
+    uint16_t double_tap;
+    uint16_t double_single_tap;
+} td_row_t;
+
+#define TAP_DANCE_ROW(dance, max_tier, flags, single_tap, single_hold, double_tap, double_single_tap) \
+    [dance] = {max_tier, flags, single_tap, single_hold, double_tap, double_single_tap},
+
+static const td_row_t td_rows[] PROGMEM = {
+    TAP_DANCE_TABLE(TAP_DANCE_ROW)
 };
 
+_Static_assert(ARRAY_SIZE(td_rows) == TAP_DANCE_COUNT, "Every tap dance needs a row in TAP_DANCE_TABLE");
 
-static void ampersand_pipe_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[AMPERSAND_PIPE].state = cur_dance(state);
-    switch (tap_states[AMPERSAND_PIPE].state) {
-        case TD_SINGLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_7);
-            break;
-        case TD_SINGLE_HOLD:
-            register_code(KC_LALT);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_BSLS);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            register_code(KC_LSFT);
-            tap_code(KC_7);
-            register_code(KC_7);
-            break;
-        default: break;
-    }
-}
+static td_tap_t tap_states[TAP_DANCE_COUNT];
 
-static void ampersand_pipe_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[AMPERSAND_PIPE].state) {
+// Keycode the row sends for a resolved state, KC_NO when the tier is unused.
+static uint16_t td_keycode(uint8_t dance, td_state_t state) {
+    const td_row_t *row = &td_rows[dance];
+    switch (state) {
         case TD_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_7);
-            break;
+            return pgm_read_word(&row->single_tap);
         case TD_SINGLE_HOLD:
-            unregister_code(KC_LALT);
-            break;
+            return pgm_read_word(&row->single_hold);
+        case TD_DOUBLE_SINGLE_TAP: {
+            uint16_t keycode = pgm_read_word(&row->double_single_tap);
+            if (keycode != KC_NO) return keycode;
+            return pgm_read_word(&row->double_tap);
+        }
         case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_BSLS);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_7);
-            break;
-        default: break;
+            return pgm_read_word(&row->double_tap);
+        default:
+            return KC_NO;
     }
-    tap_states[AMPERSAND_PIPE].state = TD_NONE;
 }
 
-static void asterisk_circle_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[ASTERISK_CIRCLE].state = cur_dance(state);
-    switch (tap_states[ASTERISK_CIRCLE].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            register_code(KC_LSFT);
-            register_code(KC_8);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_6);
-            break;
-        case TD_DOUBLE_SINGLE_TAP: 
-            register_code(KC_LSFT);
-            tap_code(KC_8);
-            register_code(KC_8);
-            break;
-        default: break;
-    }
+#ifdef TAP_DANCE_PERMISSIVE_HOLD
+// Dance whose first tap is held down, TAP_DANCE_COUNT when there is none.
+static uint8_t            td_held = TAP_DANCE_COUNT;
+static tap_dance_state_t *td_held_state;
+static keypos_t           td_held_key;
+static keypos_t           td_pressed_key;
+// Press of another key that arrived during the held tap, waiting for the dance to resolve.
+static keyevent_t td_deferred;
+static bool       td_deferring;
+static bool       td_in_replay;
+
+static void td_replay_deferred(void) {
+    td_held = TAP_DANCE_COUNT;
+    if (!td_deferring) return;
+    td_deferring = false;
+    td_in_replay = true;
+    action_exec(td_deferred);
+    td_in_replay = false;
 }
-
-static void asterisk_circle_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[ASTERISK_CIRCLE].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_8);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_6);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_8);
-            break;
-        default: break;
-    }
-    tap_states[ASTERISK_CIRCLE].state = TD_NONE;
+#endif
+
+bool td_replaying(void) {
+#ifdef TAP_DANCE_PERMISSIVE_HOLD
+    return td_in_replay;
+#else
+    return false;
+#endif
 }
 
-static void braces_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[BRACES].state = cur_dance(state);
-    switch (tap_states[BRACES].state) {
-        case TD_SINGLE_TAP:
-            register_code(KC_LBRC);
-            break;
-        case TD_SINGLE_HOLD:
-            register_code(KC_LCTL);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_RBRC);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            tap_code(KC_LBRC);
-            register_code(KC_LBRC);
-            break;
-        default: break;
-    }
+/* Output stage. Keycodes go into the keyboard report without sending it, td_flush()
+ * then sends every change since the last flush as one report. A modifier mask and its
+ * key land in the same report, so a shifted symbol costs a single report. Releasing a
+ * key and pressing it again needs a flush in between, or the host never sees it go up.
+ */
+static bool td_report_dirty;
+
+static void td_flush(void) {
+    if (!td_report_dirty) return;
+    td_report_dirty = false;
+    send_keyboard_report();
+#ifdef EVENT_LOG_ENABLE
+    // A dance that resolves after its key went up is reset in the same pass, before the log looks.
+    event_log_report();
+#endif
 }
 
-static void braces_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[BRACES].state) {
-        case TD_SINGLE_TAP:
-            unregister_code(KC_LBRC);
-            break;
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_LCTL);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_RBRC);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LBRC);
-            break;
-        default: break;
+static void td_add(uint16_t keycode) {
+    if (IS_MODIFIER_KEYCODE(keycode)) {
+        add_mods(MOD_BIT(keycode));
+    } else {
+        do_code16(keycode, add_weak_mods);
+        add_key(QK_MODS_GET_BASIC_KEYCODE(keycode));
     }
-    tap_states[BRACES].state = TD_NONE;
+    td_report_dirty = true;
 }
 
-static void curly_braces_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[CURLY_BRACES].state = cur_dance(state);
-    switch (tap_states[CURLY_BRACES].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            register_code(KC_LSFT);
-            register_code(KC_LBRC);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_RBRC);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            register_code(KC_LSFT);
-            tap_code(KC_LBRC);
-            register_code(KC_LBRC);
-            break;
-        default: break;
+static void td_del(uint16_t keycode) {
+    if (IS_MODIFIER_KEYCODE(keycode)) {
+        del_mods(MOD_BIT(keycode));
+    } else {
+        del_key(QK_MODS_GET_BASIC_KEYCODE(keycode));
+        do_code16(keycode, del_weak_mods);
     }
+    td_report_dirty = true;
 }
 
-static void curly_braces_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[CURLY_BRACES].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_LBRC);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_RBRC);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_LBRC);
-            break;
-        default: break;
+// Register the keycode of the tier the dance resolved to.
+static void td_send(uint8_t dance) {
+    td_tap_t *tap       = &tap_states[dance];
+    uint16_t  keycode   = td_keycode(dance, tap->state);
+    // Two single taps: send the first one now, the second one is held like any other tier.
+    bool      tap_first = tap->state == TD_DOUBLE_SINGLE_TAP && pgm_read_word(&td_rows[dance].double_single_tap) != KC_NO;
+    bool      guessed   = tap->speculated && keycode == pgm_read_word(&td_rows[dance].single_tap);
+
+#ifdef LATENCY_ENABLE
+    // One sample per dance, up to its first report, which a right guess sent on the press.
+    latency_record_dance(dance, tap->state, guessed ? 0 : timer_elapsed(tap->pressed_at));
+#endif
+    if (tap->speculated) {
+        tap->speculated = false;
+        if (guessed) {
+            // The guess was right, and the first of two single taps is already out.
+            if (!tap_first) return;
+            tap_first = false;
+        } else {
+            if (tap->keycode != KC_NO) td_del(tap->keycode);
+            tap->keycode = KC_NO;
+            // The Backspace goes out in the same report as the release of the speculated keycode.
+            td_add(KC_BSPC);
+            td_flush();
+            td_del(KC_BSPC);
+        }
     }
-    tap_states[CURLY_BRACES].state = TD_NONE;
-}
+#ifdef EVENT_LOG_ENABLE
+    event_log_dance(dance, tap->state);
+#endif
 
-static void equal_plus_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[EQUAL_PLUS].state = cur_dance(state);
-    switch (tap_states[EQUAL_PLUS].state) {
-        case TD_SINGLE_TAP:
-            register_code(KC_EQL);
-            break;
-        case TD_SINGLE_HOLD:
-            register_code(KC_RCTL);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_EQL);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            tap_code(KC_EQL);
-            register_code(KC_EQL);
-            break;
-        default: break;
+    if (keycode == KC_NO) {
+        td_flush();
+        return;
     }
-}
-
-static void equal_plus_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[EQUAL_PLUS].state) {
-        case TD_SINGLE_TAP:
-            unregister_code(KC_EQL);
-            break;
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_RCTL);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_EQL);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_EQL);
-        default: break;
+    if (tap_first) {
+        td_add(keycode);
+        td_flush();
+        td_del(keycode);
+        td_flush();
     }
-    tap_states[EQUAL_PLUS].state = TD_NONE;
+    td_add(keycode);
+    td_flush();
+    tap->keycode = keycode;
 }
 
-static void grave_tilde_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[GRAVE_TILDE].state = cur_dance(state);
-    switch (tap_states[GRAVE_TILDE].state) {
-        case TD_SINGLE_TAP:
-            register_code(KC_GRV);
-            break;
-        case TD_SINGLE_HOLD:
-            register_code(KC_LGUI);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_GRV);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            tap_code(KC_GRV);
-            register_code(KC_GRV);
-            break;
-        default: break;
-    }
+// Resolve the dance without waiting for QMK, the release of the dance key still resets it.
+static void td_commit(tap_dance_state_t *state, uint8_t dance, td_state_t resolved) {
+    state->finished         = true;
+    tap_states[dance].state = resolved;
+    td_send(dance);
 }
 
-static void grave_tilde_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[GRAVE_TILDE].state) {
-        case TD_SINGLE_TAP:
-            unregister_code(KC_GRV);
-            break;
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_LGUI);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_GRV);
+/* Return the tier a dance that just reached its max tier resolves to, or TD_NONE when the
+ * tiers left at this tap count still send different keycodes.
+ */
+static td_state_t td_determined(uint8_t dance, uint8_t count) {
+    if (count != pgm_read_byte(&td_rows[dance].max_tier)) return TD_NONE;
+    switch (count) {
+        case 1:
+            if (td_keycode(dance, TD_SINGLE_HOLD) == td_keycode(dance, TD_SINGLE_TAP)) return TD_SINGLE_TAP;
             break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_GRV);
+        case 2:
+            if (td_keycode(dance, TD_DOUBLE_SINGLE_TAP) == td_keycode(dance, TD_DOUBLE_TAP)) return TD_DOUBLE_TAP;
             break;
-        default: break;
     }
-    tap_states[GRAVE_TILDE].state = TD_NONE;
+    return TD_NONE;
 }
 
-static void lessthan_greaterthan_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[LESSTHAN_GREATERTHAN].state = cur_dance(state);
-    switch (tap_states[LESSTHAN_GREATERTHAN].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            register_code(KC_LSFT);
-            register_code(KC_COMM);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_DOT);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            register_code(KC_LSFT);
-            tap_code(KC_COMM);
-            register_code(KC_COMM);
-            break;
-        default: break;
-    }
-}
+#ifdef TAP_DANCE_OVERRIDES
+static bool td_partner;
 
-static void lessthan_greaterthan_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[LESSTHAN_GREATERTHAN].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_COMM);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_DOT);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_COMM);
-            break;
-        default: break;
-    }
-    tap_states[LESSTHAN_GREATERTHAN].state = TD_NONE;
+void td_override_partner(bool held) {
+    td_partner = held;
 }
 
-static void paranthesis_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[PARANTHESIS].state = cur_dance(state);
-    switch (tap_states[PARANTHESIS].state) {
-        case TD_SINGLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_9);
-            break;
-        case TD_SINGLE_HOLD:
-            register_code(KC_LSFT);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_0);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            register_code(KC_LSFT);
-            tap_code(KC_9);
-            register_code(KC_9);
-            break;
-        default: break;
+// Resolve a TD_PAIR dance on its press, so it never waits for a second tap.
+static void td_override(tap_dance_state_t *state, uint8_t dance) {
+    uint8_t shift = get_mods() & MOD_MASK_SHIFT;
+    if (!shift) {
+        td_commit(state, dance, td_partner ? TD_DOUBLE_TAP : TD_SINGLE_TAP);
+        return;
     }
+    // The partner carries its own Shift when it needs one, so it is tapped with the held one let go.
+    uint16_t keycode        = pgm_read_word(&td_rows[dance].double_tap);
+    state->finished         = true;
+    tap_states[dance].state = TD_DOUBLE_TAP;
+#    ifdef LATENCY_ENABLE
+    latency_record_dance(dance, TD_DOUBLE_TAP, 0);
+#    endif
+#    ifdef EVENT_LOG_ENABLE
+    event_log_dance(dance, TD_DOUBLE_TAP);
+#    endif
+    del_mods(shift);
+    td_add(keycode);
+    td_flush();
+    td_del(keycode);
+    td_flush();
+    add_mods(shift);
 }
+#endif
 
-static void paranthesis_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[PARANTHESIS].state) {
-        case TD_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_9);
-            break;
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_LSFT);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_0);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_9);
-            break;
-        default: break;
+static void td_each_tap(tap_dance_state_t *state, void *user_data) {
+    uint8_t   dance = (uintptr_t)user_data;
+    td_tap_t *tap   = &tap_states[dance];
+    if (state->count == 1) {
+        tap->pressed_at = timer_read();
+#ifdef TAP_DANCE_OVERRIDES
+        if (pgm_read_byte(&td_rows[dance].flags) & TD_PAIR) {
+            td_override(state, dance);
+            return;
+        }
+#endif
+        // Only while typing: with Ctrl, Alt or GUI held the guess would be a shortcut of its own.
+        if ((pgm_read_byte(&td_rows[dance].flags) & TD_SPECULATE) && !((get_mods() | get_oneshot_mods()) & ~MOD_MASK_SHIFT)) {
+            tap->keycode    = pgm_read_word(&td_rows[dance].single_tap);
+            tap->speculated = true;
+            td_add(tap->keycode);
+            td_flush();
+#ifdef EVENT_LOG_ENABLE
+            event_log_dance(dance, TD_SINGLE_TAP);
+#endif
+        }
     }
-    tap_states[PARANTHESIS].state = TD_NONE;
-}
 
-static void q_escape_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[Q_ESCAPE].state = cur_dance(state);
-    switch (tap_states[Q_ESCAPE].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            register_code(KC_Q);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_ESC);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            tap_code(KC_Q);
-            register_code(KC_Q);
-            break;
-        default: break;
+#ifdef TAP_DANCE_PERMISSIVE_HOLD
+    if (state->count == 1 && td_keycode(dance, TD_SINGLE_HOLD) != td_keycode(dance, TD_SINGLE_TAP)) {
+        td_held       = dance;
+        td_held_state = state;
+        td_held_key   = td_pressed_key;
+    } else if (td_held == dance) {
+        td_held = TAP_DANCE_COUNT;
     }
-}
+#endif
 
-static void q_escape_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[Q_ESCAPE].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_Q);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_ESC);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_Q);
-            break;
-        default: break;
-    }
-    tap_states[Q_ESCAPE].state = TD_NONE;
+    td_state_t determined = td_determined(dance, state->count);
+    if (determined != TD_NONE) td_commit(state, dance, determined);
 }
 
-static void question_exclamation_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[QUESTION_EXCLAMATION].state = cur_dance(state);
-    switch (tap_states[QUESTION_EXCLAMATION].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            register_code(KC_LSFT);
-            register_code(KC_SLSH);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_1);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            register_code(KC_LSFT);
-            tap_code(KC_SLSH);
-            register_code(KC_SLSH);
-            break;
-        default: break;
-    }
+static void td_finished(tap_dance_state_t *state, void *user_data) {
+    uint8_t dance = (uintptr_t)user_data;
+    tap_states[dance].state = cur_dance(state);
+    td_send(dance);
+#ifdef TAP_DANCE_PERMISSIVE_HOLD
+    if (td_held == dance) td_replay_deferred();
+#endif
 }
 
-static void question_exclamation_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[QUESTION_EXCLAMATION].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_SLSH);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_1);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_SLSH);
-            break;
-        default: break;
-    }
-    tap_states[QUESTION_EXCLAMATION].state = TD_NONE;
-}
+static void td_reset(tap_dance_state_t *state, void *user_data) {
+    uint8_t   dance = (uintptr_t)user_data;
+    td_tap_t *tap   = &tap_states[dance];
 
-static void quote_doublequote_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[QUOTE_DOUBLEQUOTE].state = cur_dance(state);
-    switch (tap_states[QUOTE_DOUBLEQUOTE].state) {
-        case TD_SINGLE_TAP:
-            register_code(KC_QUOT);
-            break;
-        case TD_SINGLE_HOLD:
-            register_code(KC_RSFT);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_QUOT);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            tap_code(KC_QUOT);
-            register_code(KC_QUOT);
-            break;
-        default: break;
+    if (tap->keycode != KC_NO) {
+        td_del(tap->keycode);
+        td_flush();
     }
+    tap->keycode    = KC_NO;
+    tap->speculated = false;
+    tap->state      = TD_NONE;
+#ifdef TAP_DANCE_PERMISSIVE_HOLD
+    if (td_held == dance) td_held = TAP_DANCE_COUNT;
+#endif
 }
 
-static void quote_doublequote_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[QUOTE_DOUBLEQUOTE].state) {
-        case TD_SINGLE_TAP:
-            unregister_code(KC_QUOT);
-            break;
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_RSFT);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_QUOT);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_QUOT);
-            break;
-        default: break;
+bool td_pre_process_record(uint16_t keycode, keyrecord_t *record) {
+    if (IS_QK_TAP_DANCE(keycode) && !record->event.pressed && QK_TAP_DANCE_GET_INDEX(keycode) < TAP_DANCE_COUNT) {
+        td_tap_t *tap = &tap_states[QK_TAP_DANCE_GET_INDEX(keycode)];
+        // A speculated tap is released with the key as long as the dance is undecided.
+        if (tap->speculated && tap->state == TD_NONE && tap->keycode != KC_NO) {
+            td_del(tap->keycode);
+            td_flush();
+            tap->keycode = KC_NO;
+        }
     }
-    tap_states[QUOTE_DOUBLEQUOTE].state = TD_NONE;
-}
 
-static void semicolon_colon_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[SEMICOLON_COLON].state = cur_dance(state);
-    switch (tap_states[SEMICOLON_COLON].state) {
-        case TD_SINGLE_TAP:
-            register_code(KC_SCLN);
-            break;
-        case TD_SINGLE_HOLD:
-            register_code(KC_RGUI);
-            break;
-        case TD_DOUBLE_TAP:
-        case TD_DOUBLE_SINGLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_SCLN);
-            break;
-        default: break;
+#ifdef TAP_DANCE_PERMISSIVE_HOLD
+    if (td_held == TAP_DANCE_COUNT) return true;
+    if (td_held_state->finished) {
+        td_replay_deferred();
+        return true;
     }
-}
 
-static void semicolon_colon_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[SEMICOLON_COLON].state) {
-        case TD_SINGLE_TAP:
-            unregister_code(KC_SCLN);
-            break;
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_RGUI);
-            break;
-        case TD_DOUBLE_TAP:
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_SCLN);
-            break;
-        default: break;
+    if (keycode == TD(td_held)) {
+        // Released before the other key: QMK's own interrupt turns the dance into a tap.
+        if (!record->event.pressed) td_replay_deferred();
+        return true;
     }
-    tap_states[SEMICOLON_COLON].state = TD_NONE;
-}
-
-static void slash_backslash_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[SLASH_BACKSLASH].state = cur_dance(state);
-    switch (tap_states[SLASH_BACKSLASH].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            register_code(KC_SLSH);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_BSLS);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            tap_code(KC_SLSH);
-            register_code(KC_SLSH);
-        default: break;
+    if (record->event.pressed) {
+#    ifdef OPPOSITE_HAND_HOLD
+        if (tap_hold_opposite_hands(td_held_key, record->event.key)) {
+            // A key on the other half, the dance key is being held as a modifier.
+            td_commit(td_held_state, td_held, TD_SINGLE_HOLD);
+            td_replay_deferred();
+            return true;
+        }
+        if (tap_hold_same_hand(td_held_key, record->event.key)) {
+            // A roll on the same half, QMK's own interrupt turns the dance into a tap.
+            td_replay_deferred();
+            return true;
+        }
+#    endif
+        if (td_deferring) {
+            // A second key went down as well, that is a roll rather than a nested tap.
+            td_replay_deferred();
+            return true;
+        }
+        td_deferred  = record->event;
+        td_deferring = true;
+        return false;
     }
-}
-
-static void slash_backslash_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[SLASH_BACKSLASH].state) {
-        case TD_SINGLE_TAP:
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_SLSH);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_BSLS);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_SLSH);
-        default: break;
+    if (td_deferring && KEYEQ(record->event.key, td_deferred.key)) {
+        // Nested press and release while the dance key is still down.
+        td_commit(td_held_state, td_held, TD_SINGLE_HOLD);
+        td_replay_deferred();
     }
-    tap_states[SLASH_BACKSLASH].state = TD_NONE;
+#endif
+    return true;
 }
 
-static void underscore_minus_finished(tap_dance_state_t *state, void *user_data) {
-    tap_states[UNDERSCORE_MINUS].state = cur_dance(state);
-    switch (tap_states[UNDERSCORE_MINUS].state) {
-        case TD_SINGLE_TAP:
-            register_code(KC_LSFT);
-            register_code(KC_MINS);
-            break;
-        case TD_SINGLE_HOLD:
-            register_code(KC_RALT);
-            break;
-        case TD_DOUBLE_TAP:
-            register_code(KC_MINS);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            register_code(KC_LSFT);
-            tap_code(KC_MINS);
-            register_code(KC_MINS);
-            break;
-        default: break;
-    }
+void td_process_record(uint16_t keycode, keyrecord_t *record) {
+#ifdef TAP_DANCE_PERMISSIVE_HOLD
+    // Remembered for td_each_tap(), which runs for this press next without knowing where the key is.
+    if (IS_QK_TAP_DANCE(keycode) && record->event.pressed) td_pressed_key = record->event.key;
+#endif
 }
 
-static void underscore_minus_reset(tap_dance_state_t *state, void *user_data) {
-    switch (tap_states[UNDERSCORE_MINUS].state) {
-        case TD_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            unregister_code(KC_MINS);
-            break;
-        case TD_SINGLE_HOLD:
-            unregister_code(KC_RALT);
-            break;
-        case TD_DOUBLE_TAP:
-            unregister_code(KC_MINS);
-            break;
-        case TD_DOUBLE_SINGLE_TAP:
-            unregister_code(KC_LSFT);
-            register_code(KC_MINS);
-            break;
-        default: break;
-    }
-    tap_states[UNDERSCORE_MINUS].state = TD_NONE;
-}
+#define TAP_DANCE_ACTION(dance, ...) \
+    [dance] = {.fn = {td_each_tap, td_finished, td_reset}, .user_data = (void *)(uintptr_t)dance},
 
 tap_dance_action_t tap_dance_actions[] = {
-    [AMPERSAND_PIPE] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, ampersand_pipe_finished, ampersand_pipe_reset),
-    [ASTERISK_CIRCLE] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, asterisk_circle_finished, asterisk_circle_reset),
-    [BRACES] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, braces_finished, braces_reset),
-    [CURLY_BRACES] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, curly_braces_finished, curly_braces_reset),
-    [EQUAL_PLUS] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, equal_plus_finished, equal_plus_reset),
-    [GRAVE_TILDE] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, grave_tilde_finished, grave_tilde_reset),
-    [LESSTHAN_GREATERTHAN] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, lessthan_greaterthan_finished, lessthan_greaterthan_reset),
-    [PARANTHESIS] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, paranthesis_finished, paranthesis_reset),
-    [Q_ESCAPE] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, q_escape_finished, q_escape_reset),
-    [QUESTION_EXCLAMATION] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, question_exclamation_finished, question_exclamation_reset),
-    [QUOTE_DOUBLEQUOTE] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, quote_doublequote_finished, quote_doublequote_reset),
-    [SEMICOLON_COLON] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, semicolon_colon_finished, semicolon_colon_reset),
-    [SLASH_BACKSLASH] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, slash_backslash_finished, slash_backslash_reset),
-    [UNDERSCORE_MINUS] = ACTION_TAP_DANCE_FN_ADVANCED(NULL, underscore_minus_finished, underscore_minus_reset),
+    TAP_DANCE_TABLE(TAP_DANCE_ACTION)
 };
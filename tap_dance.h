@@ -1,21 +1,67 @@
-#ifndef FERRIS_SWEEP_TAP_DANCE_H 
+#ifndef FERRIS_SWEEP_TAP_DANCE_H
 #define FERRIS_SWEEP_TAP_DANCE_H
 
+/* One row per tap dance, in the order of the enum below.
+ *
+ * Each keycode column is what that tier of the dance sends. Keycodes may carry
+ * their modifier mask (KC_AMPR is LSFT(KC_7)), and a bare modifier such as KC_LALT
+ * turns the tier into a hold modifier.
+ *
+ * The double single tap is what two quick taps followed by another key send, it is
+ * tapped once and then held. KC_NO makes it fall back to the double tap.
+ *
+ * The max tier is the highest tap count the dance reacts to. Once it is reached and
+ * every remaining tier sends the same keycode, the dance resolves on that press
+ * instead of waiting out the tapping term.
+ *
+ * Flags:
+ *  TD_SPECULATE  Send the single tap on the first press. If the dance resolves to
+ *                anything else, a Backspace takes it back first. Only safe for
+ *                keycodes that type one character, such as letters. With a
+ *                modifier other than Shift held, the dance waits like the others.
+ *  TD_PAIR       The dance only pairs a symbol with its partner. With
+ *                TAP_DANCE_OVERRIDES it resolves on the press: the double tap
+ *                while Shift or the PARTNER key is held, the single tap otherwise.
+ */
+#define TD_SPECULATE (1 << 0)
+#define TD_PAIR (1 << 1)
+
+#define TAP_DANCE_TABLE(X) \
+    /* dance                  max tier  flags         single tap  single hold  double tap  double single tap */ \
+    X(AMPERSAND_PIPE,        2,        0,            KC_AMPR,    KC_LALT,     KC_PIPE,    KC_AMPR) \
+    X(ASTERISK_CIRCLE,       2,        TD_PAIR,      KC_ASTR,    KC_ASTR,     KC_CIRC,    KC_ASTR) \
+    X(BRACES,                2,        0,            KC_LBRC,    KC_LCTL,     KC_RBRC,    KC_LBRC) \
+    X(CURLY_BRACES,          2,        TD_PAIR,      KC_LCBR,    KC_LCBR,     KC_RCBR,    KC_LCBR) \
+    X(EQUAL_PLUS,            2,        0,            KC_EQL,     KC_RCTL,     KC_PLUS,    KC_EQL) \
+    X(GRAVE_TILDE,           2,        0,            KC_GRV,     KC_LGUI,     KC_TILD,    KC_GRV) \
+    X(LESSTHAN_GREATERTHAN,  2,        TD_PAIR,      KC_LT,      KC_LT,       KC_GT,      KC_LT) \
+    X(PARANTHESIS,           2,        0,            KC_LPRN,    KC_LSFT,     KC_RPRN,    KC_LPRN) \
+    X(Q_ESCAPE,              2,        TD_SPECULATE, KC_Q,       KC_Q,        KC_ESC,     KC_Q) \
+    X(QUESTION_EXCLAMATION,  2,        TD_PAIR,      KC_QUES,    KC_QUES,     KC_EXLM,    KC_QUES) \
+    X(QUOTE_DOUBLEQUOTE,     2,        0,            KC_QUOT,    KC_RSFT,     KC_DQUO,    KC_QUOT) \
+    X(SEMICOLON_COLON,       2,        0,            KC_SCLN,    KC_RGUI,     KC_COLN,    KC_NO) \
+    X(SLASH_BACKSLASH,       2,        TD_PAIR,      KC_SLSH,    KC_SLSH,     KC_BSLS,    KC_SLSH) \
+    X(UNDERSCORE_MINUS,      2,        0,            KC_UNDS,    KC_RALT,     KC_MINS,    KC_UNDS)
+
+#define TAP_DANCE_ENUM(dance, ...) dance,
+
 enum {
-    AMPERSAND_PIPE,
-    ASTERISK_CIRCLE,
-    BRACES,
-    CURLY_BRACES,
-    EQUAL_PLUS,
-    GRAVE_TILDE,
-    LESSTHAN_GREATERTHAN,
-    PARANTHESIS,
-    Q_ESCAPE,
-    QUESTION_EXCLAMATION,
-    QUOTE_DOUBLEQUOTE,
-    SEMICOLON_COLON,
-    SLASH_BACKSLASH,
-    UNDERSCORE_MINUS,
+    TAP_DANCE_TABLE(TAP_DANCE_ENUM)
+    TAP_DANCE_COUNT
 };
 
+// Call from pre_process_record_user(), returns false when the event is held back.
+bool td_pre_process_record(uint16_t keycode, keyrecord_t *record);
+/* True while a press td_pre_process_record() held back goes through action_exec() again.
+ * pre_process_record_user() has already seen it once, only the dance needs it the second time.
+ */
+bool td_replaying(void);
+// Call first thing from process_record_user(), QMK runs the dance for a press right after it.
+void td_process_record(uint16_t keycode, keyrecord_t *record);
+
+#ifdef TAP_DANCE_OVERRIDES
+// The PARTNER key went down or up.
+void td_override_partner(bool held);
+#endif
+
 #endif
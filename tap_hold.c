@@ -0,0 +1,334 @@
+#include QMK_KEYBOARD_H
+
+#include "layers.h"
+#include "tap_dance.h"
+#include "tap_hold.h"
+#include "tuning.h"
+
+typedef struct {
+    uint16_t keycode;
+    int8_t   offset; // From the tapping term, which can be tuned at run time
+    uint8_t  policy; // What another key pressed while it is undecided means, see tap_hold.h
+} tap_hold_key_t;
+
+#define TAP_HOLD_DANCE(dance, ...) {TD(dance), 0, TAP_HOLD_PERMISSIVE},
+
+static const tap_hold_key_t tap_hold_keys[] PROGMEM = {
+    // Home row mods, the pinkies and ring fingers are the slowest to come back up
+    {LGUI_T(KC_A), 40, TAP_HOLD_PERMISSIVE},
+    {LALT_T(KC_S), 20, TAP_HOLD_PERMISSIVE},
+    {LCTL_T(KC_D), 0, TAP_HOLD_PERMISSIVE},
+    {LSFT_T(KC_F), -20, TAP_HOLD_PERMISSIVE},
+    {RSFT_T(KC_J), -20, TAP_HOLD_PERMISSIVE},
+    {RCTL_T(KC_K), 0, TAP_HOLD_PERMISSIVE},
+    {RALT_T(KC_L), 20, TAP_HOLD_PERMISSIVE},
+    // Thumbs, their layers are reached without waiting
+    {LT(MEDIA, KC_TAB), 0, TAP_HOLD_EAGER},
+    {LT(NAVIGATION, KC_SPC), 0, TAP_HOLD_EAGER},
+    {LT(SYMBOL, KC_BSPC), 0, TAP_HOLD_EAGER},
+    {LT(FUNCTION, KC_ENT), 0, TAP_HOLD_EAGER},
+    // Tap dances last and in their own order, so a dance's slot follows from its index
+    TAP_DANCE_TABLE(TAP_HOLD_DANCE)
+};
+
+#define TAP_HOLD_KEY_COUNT ARRAY_SIZE(tap_hold_keys)
+#define TAP_HOLD_DANCE_SLOT (TAP_HOLD_KEY_COUNT - TAP_DANCE_COUNT)
+
+#ifdef TAPPING_TERM_ADAPTIVE
+#    define TAP_HOLD_EECONFIG_VERSION 1
+
+typedef struct {
+    uint8_t version;
+    uint8_t terms[TAP_HOLD_KEY_COUNT]; // In 2 ms units, 0 until the key has learned one
+} tap_hold_eeconfig_t;
+
+// The learned terms have the start of the user datablock, tuning.c the rest
+_Static_assert(sizeof(tap_hold_eeconfig_t) <= TUNING_EEPROM_OFFSET, "The learned terms outgrew their part of the user datablock");
+_Static_assert(TAPPING_TERM <= TAPPING_TERM_MAX && TAPPING_TERM_ADAPTIVE_MAX <= TAPPING_TERM_MAX, "TAPPING_TERM_MAX has to bound every tapping term");
+
+static tap_hold_eeconfig_t learned;
+static uint16_t            pressed_at[TAP_HOLD_KEY_COUNT];
+// Last tap durations of each key in 2 ms units, oldest overwritten first
+static uint8_t  samples[TAP_HOLD_KEY_COUNT][TAPPING_TERM_ADAPTIVE_WINDOW];
+static uint8_t  sample_count[TAP_HOLD_KEY_COUNT];
+static bool     learned_dirty;
+static uint32_t learned_dirty_since;
+#endif
+
+tap_hold_stats_t tap_hold_stats;
+
+// Mod-taps and layer-taps QMK has not resolved yet, the last one pressed is kept apart
+static matrix_row_t unresolved_keys[MATRIX_ROWS];
+static uint8_t      unresolved_count;
+static keypos_t     unresolved_key;
+static uint16_t     unresolved_keycode;
+static uint16_t     unresolved_since;
+
+#ifdef TYPING_STREAK_TERM
+static uint16_t     typing_last;
+static bool         typing;
+static matrix_row_t streak_keys[MATRIX_ROWS];
+#endif
+
+#ifdef OPPOSITE_HAND_HOLD
+static keypos_t     last_pressed;
+// Mod-taps already tapped on behalf of a same hand press, their own release is dropped
+static matrix_row_t same_hand_keys[MATRIX_ROWS];
+#endif
+
+// Slot each key position last found, checked against the keycode since another layer can put another key there
+static int8_t position_slots[MATRIX_ROWS][MATRIX_COLS];
+
+static int8_t tap_hold_slot(uint16_t keycode, keyrecord_t *record) {
+    // QMK asks about a dance with an empty record, its slot needs no position.
+    if (IS_QK_TAP_DANCE(keycode)) {
+        uint8_t dance = QK_TAP_DANCE_GET_INDEX(keycode);
+        return dance < TAP_DANCE_COUNT ? (int8_t)(TAP_HOLD_DANCE_SLOT + dance) : -1;
+    }
+    if (!IS_QK_MOD_TAP(keycode) && !IS_QK_LAYER_TAP(keycode)) return -1;
+
+    keypos_t key    = record->event.key;
+    bool     in_map = key.row < MATRIX_ROWS && key.col < MATRIX_COLS; // Not a combo
+    if (in_map) {
+        int8_t slot = position_slots[key.row][key.col];
+        if (pgm_read_word(&tap_hold_keys[slot].keycode) == keycode) return slot;
+    }
+    for (uint8_t i = 0; i < TAP_HOLD_DANCE_SLOT; i++) {
+        if (pgm_read_word(&tap_hold_keys[i].keycode) != keycode) continue;
+        if (in_map) position_slots[key.row][key.col] = i;
+        return i;
+    }
+    return -1;
+}
+
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+    int8_t slot = tap_hold_slot(keycode, record);
+    if (slot < 0) return tuning[TUNING_TAPPING_TERM];
+#ifdef TAPPING_TERM_ADAPTIVE
+    if (learned.terms[slot]) return learned.terms[slot] * 2;
+#endif
+    return MIN(tuning[TUNING_TAPPING_TERM] + (int8_t)pgm_read_byte(&tap_hold_keys[slot].offset), TAPPING_TERM_MAX);
+}
+
+uint16_t get_quick_tap_term(uint16_t keycode, keyrecord_t *record) {
+    return tuning[TUNING_QUICK_TAP_TERM];
+}
+
+#ifdef TAPPING_TERM_ADAPTIVE
+static void tap_hold_learn(uint8_t slot, uint16_t held) {
+    uint8_t count = sample_count[slot];
+    samples[slot][count % TAPPING_TERM_ADAPTIVE_WINDOW] = MIN(held / 2, UINT8_MAX);
+    // Keep the count in [WINDOW, 2 * WINDOW) once full, so it never wraps back to "not full"
+    sample_count[slot] = count + 1 < 2 * TAPPING_TERM_ADAPTIVE_WINDOW ? count + 1 : TAPPING_TERM_ADAPTIVE_WINDOW;
+    if (sample_count[slot] < TAPPING_TERM_ADAPTIVE_WINDOW) return;
+
+    uint8_t slowest = 0;
+    for (uint8_t i = 0; i < TAPPING_TERM_ADAPTIVE_WINDOW; i++) {
+        slowest = MAX(slowest, samples[slot][i]);
+    }
+    uint16_t term = slowest * 2 + TAPPING_TERM_ADAPTIVE_MARGIN;
+    term          = MIN(MAX(term, TAPPING_TERM_ADAPTIVE_MIN), TAPPING_TERM_ADAPTIVE_MAX);
+    if (term / 2 == learned.terms[slot]) return;
+
+    learned.terms[slot] = term / 2;
+    if (!learned_dirty) {
+        learned_dirty       = true;
+        learned_dirty_since = timer_read32();
+    }
+}
+#endif
+
+#ifdef TYPING_STREAK_TERM
+static bool is_letter(uint16_t keycode) {
+    return keycode >= KC_A && keycode <= KC_Z;
+}
+
+// The marks that end a word or a clause, from KC_MINS to KC_SLSH
+static bool is_punctuation(uint16_t keycode) {
+    return keycode >= KC_MINS && keycode <= KC_SLSH;
+}
+
+static bool is_typing(uint16_t keycode, keyrecord_t *record) {
+    if (IS_QK_MOD_TAP(keycode)) return record->tap.count && is_letter(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+    // The Space between two words keeps the streak going, so the next word can start with a home row mod.
+    // With a modifier held it is a shortcut instead.
+    if (IS_QK_LAYER_TAP(keycode)) return record->tap.count && QK_LAYER_TAP_GET_TAP_KEYCODE(keycode) == KC_SPC && !get_mods();
+    // So does the comma or period before that Space.
+    if (is_punctuation(keycode)) return !get_mods();
+    return is_letter(keycode);
+}
+
+// Asked with the press time of each key, and a thumb held back by QMK is asked after later keys.
+static bool in_streak(uint16_t time) {
+    return typing && TIMER_DIFF_16(time, typing_last) < TYPING_STREAK_TERM;
+}
+
+#endif
+
+static bool waiting_on_unresolved(void) {
+    // QMK never holds a key back longer than its tapping term, so stale ones were resolved without us seeing it.
+    if (unresolved_count && timer_elapsed(unresolved_since) > TAPPING_TERM_MAX) {
+        memset(unresolved_keys, 0, sizeof(unresolved_keys));
+        unresolved_count = 0;
+    }
+    return unresolved_count > 0;
+}
+
+#ifdef OPPOSITE_HAND_HOLD
+char tap_hold_hand(keypos_t key) {
+    return pgm_read_byte(&handedness[key.row][key.col]);
+}
+
+bool tap_hold_opposite_hands(keypos_t a, keypos_t b) {
+    char hand_a = tap_hold_hand(a);
+    char hand_b = tap_hold_hand(b);
+    return hand_a != '*' && hand_b != '*' && hand_a != hand_b;
+}
+
+bool tap_hold_same_hand(keypos_t a, keypos_t b) {
+    char hand_a = tap_hold_hand(a);
+    return hand_a != '*' && hand_a == tap_hold_hand(b);
+}
+
+#endif
+
+// Called by QMK for the undecided key when another key goes down, which is the last one pressed.
+bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) {
+    int8_t slot = tap_hold_slot(keycode, record);
+    if (slot >= 0 && pgm_read_byte(&tap_hold_keys[slot].policy) == TAP_HOLD_EAGER) {
+#ifdef TYPING_STREAK_TERM
+        // Pressed mid-word, it is most likely a Space or a Backspace rolled into the next key.
+        if (in_streak(record->event.time)) return false;
+#endif
+        tap_hold_stats.eager_holds++;
+        return true;
+    }
+#ifdef OPPOSITE_HAND_HOLD
+    if (IS_QK_MOD_TAP(keycode) && tap_hold_opposite_hands(record->event.key, last_pressed)) {
+#    ifdef TYPING_STREAK_TERM
+        // Mid-word, it is a letter rolled into the next one, whichever half that is on.
+        if (in_streak(record->event.time)) return false;
+#    endif
+        tap_hold_stats.opposite_hand_holds++;
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool tap_hold_pre_process_record(uint16_t keycode, keyrecord_t *record) {
+    keypos_t     key  = record->event.key;
+    matrix_row_t mask = (matrix_row_t)1 << key.col;
+
+    if (!record->event.pressed) {
+#ifdef OPPOSITE_HAND_HOLD
+        if (same_hand_keys[key.row] & mask) {
+            same_hand_keys[key.row] &= ~mask;
+            return false;
+        }
+#endif
+#ifdef TYPING_STREAK_TERM
+        if (streak_keys[key.row] & mask) {
+            streak_keys[key.row] &= ~mask;
+            unregister_code(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+            return false;
+        }
+#endif
+        return true;
+    }
+
+#ifdef OPPOSITE_HAND_HOLD
+    last_pressed = key;
+    // Only a lone undecided key is QMK's tapping key, anything queued behind it is left alone.
+    if (waiting_on_unresolved() && unresolved_count == 1 && IS_QK_MOD_TAP(unresolved_keycode) && tap_hold_same_hand(unresolved_key, key)) {
+        // Same hand roll: let go of the mod-tap early so QMK taps it, ahead of this press.
+        keyevent_t release = MAKE_KEYEVENT(unresolved_key.row, unresolved_key.col, false);
+        tap_hold_stats.same_hand_taps++;
+        action_exec(release);
+        // Only now, so the release above gets through and the physical one is swallowed instead.
+        same_hand_keys[unresolved_key.row] |= (matrix_row_t)1 << unresolved_key.col;
+    }
+#endif
+    if (!IS_QK_MOD_TAP(keycode) && !IS_QK_LAYER_TAP(keycode)) return true;
+
+#ifdef TYPING_STREAK_TERM
+    if (IS_QK_MOD_TAP(keycode) && get_highest_layer(layer_state | default_layer_state) == BASE) {
+        tap_hold_stats.mod_tap_presses++;
+        if (in_streak(record->event.time) && !waiting_on_unresolved() && !get_mods()) {
+            tap_hold_stats.streak_taps++;
+            streak_keys[key.row] |= mask;
+            typing_last = record->event.time;
+            register_code(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+            return false;
+        }
+    }
+#endif
+    waiting_on_unresolved(); // Drop stale ones before counting this one
+    unresolved_keys[key.row] |= mask;
+    unresolved_count++;
+    unresolved_key     = key;
+    unresolved_keycode = keycode;
+    unresolved_since   = timer_read();
+    return true;
+}
+
+void tap_hold_record(uint16_t keycode, keyrecord_t *record) {
+    keypos_t     key  = record->event.key;
+    matrix_row_t mask = (matrix_row_t)1 << key.col;
+    if (record->event.pressed && (unresolved_keys[key.row] & mask)) {
+        unresolved_keys[key.row] &= ~mask;
+        unresolved_count--;
+    }
+#ifdef TYPING_STREAK_TERM
+    if (record->event.pressed) {
+        // Anything else ends the word, which also keeps a streak from overtaking a tap dance.
+        typing      = is_typing(keycode, record);
+        typing_last = record->event.time;
+    }
+#endif
+#ifdef TAPPING_TERM_ADAPTIVE
+    int8_t slot = tap_hold_slot(keycode, record);
+    if (slot < 0) return;
+
+    if (record->event.pressed) {
+        pressed_at[slot] = record->event.time;
+        return;
+    }
+    uint16_t held = TIMER_DIFF_16(record->event.time, pressed_at[slot]);
+    // Only taps say anything about how long this key is held when it is not meant as a hold.
+    bool tapped = IS_QK_TAP_DANCE(keycode) ? held < get_tapping_term(keycode, record) : record->tap.count > 0;
+    if (tapped) tap_hold_learn(slot, held);
+#endif
+}
+
+void tap_hold_init(void) {
+#ifdef TAPPING_TERM_ADAPTIVE
+    eeprom_read_block(&learned, EECONFIG_USER_DATABLOCK, sizeof(learned));
+    if (learned.version != TAP_HOLD_EECONFIG_VERSION) {
+        memset(&learned, 0, sizeof(learned));
+        learned.version = TAP_HOLD_EECONFIG_VERSION;
+    }
+#endif
+}
+
+void tap_hold_task(void) {
+#ifdef TYPING_STREAK_TERM
+    /* Ends the streak once no press still held back can be in it, so that an old
+     * typing_last does not come round with the timer. A press time can be a ms ahead
+     * of timer_read(), hence no plain timer_elapsed().
+     */
+    if (typing && timer_expired(timer_read(), (uint16_t)(typing_last + TAPPING_TERM_MAX + TYPING_STREAK_TERM))) typing = false;
+#endif
+#ifdef TAPPING_TERM_ADAPTIVE
+    if (learned_dirty && timer_elapsed32(learned_dirty_since) > TAPPING_TERM_ADAPTIVE_SAVE_INTERVAL) {
+        eeprom_update_block(&learned, EECONFIG_USER_DATABLOCK, sizeof(learned));
+        learned_dirty = false;
+    }
+#endif
+}
+
+void tap_hold_print_stats(void) {
+    uprintf("streak: %u of %u mod-tap presses typed straight away\n", tap_hold_stats.streak_taps, tap_hold_stats.mod_tap_presses);
+    uprintf("hands: %u opposite hand holds, %u same hand taps\n", tap_hold_stats.opposite_hand_holds, tap_hold_stats.same_hand_taps);
+    uprintf("thumbs: %u layers taken on the next press\n", tap_hold_stats.eager_holds);
+}
@@ -0,0 +1,83 @@
+#ifndef FERRIS_SWEEP_TAP_HOLD_H
+#define FERRIS_SWEEP_TAP_HOLD_H
+
+/* Per-key tapping terms for the mod-taps, layer-taps and tap dances.
+ *
+ * With TAPPING_TERM_ADAPTIVE, each key also keeps its last few tap durations and
+ * moves its term to just above the slowest of them, within the bounds below. The
+ * learned terms are saved to EEPROM.
+ *
+ * With TYPING_STREAK_TERM, a base layer mod-tap pressed within that many ms of the
+ * last letter or Space is typed right away instead of going through hold/tap
+ * resolution.
+ *
+ * With OPPOSITE_HAND_HOLD, the handedness table decides what another key pressed
+ * during an undecided mod-tap or tap dance hold tier means. A key on the other half
+ * makes it a hold right away, unless the mod-tap went down during a typing streak,
+ * and a key on the same half makes it a tap. Thumbs ('*')
+ * leave the decision to the tapping term and PERMISSIVE_HOLD.
+ *
+ * Each key of the table in tap_hold.c also has a hold policy:
+ *  TAP_HOLD_PERMISSIVE  The tapping term and PERMISSIVE_HOLD decide, along with the
+ *                       rules above. Meant for the home row mods, where a roll is
+ *                       usually two letters.
+ *  TAP_HOLD_EAGER       Another key pressed while it is undecided makes it a hold,
+ *                       so its layer is there for that very key. Meant for the thumb
+ *                       layer-taps. With TYPING_STREAK_TERM, a thumb pressed during a
+ *                       streak of letters falls back to the permissive policy, as
+ *                       it is then most likely a Space rolled into the next word.
+ */
+
+enum tap_hold_policies {
+    TAP_HOLD_PERMISSIVE,
+    TAP_HOLD_EAGER,
+};
+
+// No key's term goes above this, however it is tuned or learned. Stale keys are dropped after it.
+#ifndef TAPPING_TERM_MAX
+#    define TAPPING_TERM_MAX 300
+#endif
+#ifndef TAPPING_TERM_ADAPTIVE_WINDOW
+#    define TAPPING_TERM_ADAPTIVE_WINDOW 8
+#endif
+#ifndef TAPPING_TERM_ADAPTIVE_MARGIN
+#    define TAPPING_TERM_ADAPTIVE_MARGIN 40
+#endif
+#ifndef TAPPING_TERM_ADAPTIVE_MIN
+#    define TAPPING_TERM_ADAPTIVE_MIN 120
+#endif
+#ifndef TAPPING_TERM_ADAPTIVE_MAX
+#    define TAPPING_TERM_ADAPTIVE_MAX TAPPING_TERM_MAX
+#endif
+// Learned terms are written back at most this often, to spare the EEPROM
+#ifndef TAPPING_TERM_ADAPTIVE_SAVE_INTERVAL
+#    define TAPPING_TERM_ADAPTIVE_SAVE_INTERVAL 300000
+#endif
+
+typedef struct {
+    uint16_t mod_tap_presses; // Base layer mod-tap presses
+    uint16_t streak_taps;     // ... of which were typed straight away
+    uint16_t opposite_hand_holds;
+    uint16_t same_hand_taps;
+    uint16_t eager_holds; // Thumb layers taken as soon as the next key went down
+} tap_hold_stats_t;
+
+extern tap_hold_stats_t tap_hold_stats;
+
+void tap_hold_init(void);
+void tap_hold_task(void);
+void tap_hold_record(uint16_t keycode, keyrecord_t *record);
+// Call from pre_process_record_user(), returns false when the event was handled here.
+bool tap_hold_pre_process_record(uint16_t keycode, keyrecord_t *record);
+void tap_hold_print_stats(void);
+
+#ifdef OPPOSITE_HAND_HOLD
+// 'L' or 'R' for the half each key is on, '*' for the thumbs. Defined in keymap.c
+extern const char handedness[MATRIX_ROWS][MATRIX_COLS];
+
+char tap_hold_hand(keypos_t key);
+bool tap_hold_opposite_hands(keypos_t a, keypos_t b);
+bool tap_hold_same_hand(keypos_t a, keypos_t b);
+#endif
+
+#endif
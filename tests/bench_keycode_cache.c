@@ -0,0 +1,92 @@
+/* Cost of a keycode lookup with and without KEYCODE_CACHE.
+ *
+ * The Makefile builds the keymap with KEYCODE_CACHE, which config.h leaves off, and
+ * sparse_layers.c is built a second time below with the cache left out, so both
+ * versions run on the same keymap in one program. Each row is the best of 7 runs over
+ * every matrix position:
+ *  - lookup: keycode_at_keymap_location() on the highest active layer, the one QMK asks first.
+ *  - walk: QMK's layer_switch_get_layer() and the lookup after it, from the highest active
+ *    layer down past the KC_TRNS entries, which is what a key event costs.
+ * Dense layers never go through the cache, both columns run the same code for them.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "sim.h"
+#include "layers.h"
+
+#undef KEYCODE_CACHE
+#define keycode_at_keymap_location uncached_keycode_at_keymap_location
+#include "sparse_layers.c"
+#undef keycode_at_keymap_location
+
+#define ROUNDS 20000
+#define RUNS 7
+
+typedef uint16_t (*lookup_t)(uint8_t layer, uint8_t row, uint8_t column);
+
+static volatile uint16_t sink;
+
+static uint16_t walk(lookup_t lookup, uint8_t row, uint8_t column) {
+    layer_state_t layers = layer_state | default_layer_state;
+    for (int8_t i = 31; i >= 0; i--) {
+        if ((layers & ((layer_state_t)1 << i)) && lookup(i, row, column) != KC_TRNS) return lookup(i, row, column);
+    }
+    return lookup(0, row, column);
+}
+
+static double now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Best time per lookup over RUNS runs of ROUNDS passes over the matrix, in ns.
+static double time_lookups(lookup_t lookup, bool walked) {
+    uint8_t top  = get_highest_layer(layer_state | default_layer_state);
+    double  best = 1e9;
+    for (uint8_t run = 0; run < RUNS; run++) {
+        double start = now_ns();
+        for (uint16_t round = 0; round < ROUNDS; round++) {
+            for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+                for (uint8_t column = 0; column < MATRIX_COLS; column++) {
+                    sink = walked ? walk(lookup, row, column) : lookup(top, row, column);
+                }
+            }
+        }
+        double per_lookup = (now_ns() - start) / ((double)ROUNDS * MATRIX_ROWS * MATRIX_COLS);
+        if (per_lookup < best) best = per_lookup;
+    }
+    return best;
+}
+
+static void row(const char *name, layer_state_t layers) {
+    layer_clear();
+    for (uint8_t layer = 1; layer < LAYER_COUNT; layer++) {
+        if (layers & ((layer_state_t)1 << layer)) layer_on(layer);
+    }
+    // Both versions must agree on every position before their times mean anything.
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t column = 0; column < MATRIX_COLS; column++) {
+            if (walk(keycode_at_keymap_location, row, column) != walk(uncached_keycode_at_keymap_location, row, column)) {
+                printf("%s: r%uc%u resolves differently with the cache\n", name, row, column);
+                sim_failures++;
+            }
+        }
+    }
+    printf("%-22s %8.1f %8.1f %8.1f %8.1f\n", name, time_lookups(uncached_keycode_at_keymap_location, false), time_lookups(keycode_at_keymap_location, false),
+           time_lookups(uncached_keycode_at_keymap_location, true), time_lookups(keycode_at_keymap_location, true));
+}
+
+int main(void) {
+    sim_boot();
+    printf("ns per position        lookup            walk\n");
+    printf("top layer              no cache  cache   no cache  cache\n");
+    row("BASE (dense)", 0);
+    row("SYMBOL (dense)", 1 << SYMBOL);
+    row("NAVIGATION (dense)", 1 << NAVIGATION);
+    row("FUNCTION (sparse)", 1 << FUNCTION);
+    row("MEDIA (sparse)", 1 << MEDIA);
+    row("POINTER (sparse)", (1 << NAVIGATION) | (1 << MEDIA));
+    return sim_failures ? 1 : 0;
+}
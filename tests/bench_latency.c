@@ -0,0 +1,73 @@
+/* Press-to-first-report latency per key class, over a scripted typing session.
+ *
+ * Prose is typed as overlapping rolls at about 100 words a minute, with shortcuts held
+ * on the home row mods, symbols and escapes from the tap dances, and pauses that let
+ * the dances time out. The table shows what each class of key costs on top of the
+ * scan: plain keys should read 0, a mod-tap typed as a letter waits for its release.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+#include "layers.h"
+
+#define INTERVAL_MS 60 // Between presses while typing a word
+#define HOLD_MS 90     // Each key is still down when the next one goes down
+
+static uint8_t position_of(char c) {
+    static const char *const rows = "qwertyuiopasdfghjkl;zxcvbnm,./";
+    const char              *at   = strchr(rows, c);
+    if (c == ' ') return POS_L42;
+    if (!at) {
+        fprintf(stderr, "no base layer key for '%c'\n", c);
+        abort();
+    }
+    uint8_t index = at - rows;
+    return (index / 10) * 10 + index % 10;
+}
+
+// Type text as a roll: each key goes down INTERVAL_MS after the last, and up HOLD_MS after its press.
+static void type(const char *text) {
+    uint8_t down[64];
+    uint8_t count = 0;
+    for (const char *c = text; *c; c++) {
+        sim_down(down[count++] = position_of(*c));
+        sim_wait(INTERVAL_MS - HOLD_MS % INTERVAL_MS);
+        if (count > 1) sim_up(down[count - 2]);
+        sim_wait(HOLD_MS % INTERVAL_MS);
+    }
+    sim_wait(HOLD_MS - INTERVAL_MS);
+    sim_up(down[count - 1]);
+}
+
+// Hold one key while tapping another, like a shortcut or a symbol from a layer.
+static void chord(uint8_t held, uint8_t tapped) {
+    sim_down(held);
+    sim_wait(80);
+    sim_tap(tapped);
+    sim_wait(40);
+    sim_up(held);
+    sim_wait(200);
+}
+
+int main(void) {
+    sim_boot();
+    for (uint8_t i = 0; i < 20; i++) {
+        type("the quick brown fox jumps over the lazy dog ");
+        sim_wait(400);
+        chord(POS_L23, POS_R23);  // Ctrl+K, opposite hands
+        chord(POS_R41, POS_L24);  // Symbol layer '('
+        chord(POS_R41, POS_R21);  // Symbol layer '?'
+        chord(POS_R42, POS_R11);  // Function layer F6
+        sim_tap(POS_L11);         // q, left to time out
+        sim_wait(300);
+        sim_tap(POS_L11);         // Escape
+        sim_wait(30);
+        sim_tap(POS_L11);
+        sim_wait(300);
+        type("sat, zoom.");
+        sim_wait(500);
+    }
+    sim_latency_print();
+    return sim_report_empty() ? 0 : 1;
+}
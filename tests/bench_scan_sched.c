@@ -0,0 +1,149 @@
+/* What the scan scheduler costs in latency and saves in awake time, on the primary half.
+ *
+ * Ten minutes of typing bursts and pauses: a burst lasts 3 to 20 s, with a press every
+ * 125 to 375 ms on a random top row key of either half, each held 90 ms, and a pause
+ * lasts 1 to 30 s. The same session runs with each way of sleeping between idle scans:
+ *  - off: no sleep, what the keyboard does without the scheduler.
+ *  - wait: a plain wait of the idle interval, what scan_sched.c did first. ChibiOS sleeps
+ *    in it, an AVR spins, so there it saves nothing.
+ *  - edge: scan_sched_sleep() on ChibiOS, the interval or until a pin of this half
+ *    changes. The primary half's own keys end the sleep, the secondary half's do not.
+ * The bench brings its own scan_sched_sleep() for these and sets the interval of each row.
+ *
+ * press to scan: from a key going down to the first scan of it, on the primary half's keys
+ * and on the secondary half's. The presses fall on the scans of off, so it reads 0, and
+ * the edge rows' max is a sleep that began less than a scan before the press.
+ * awake: the share of the time not spent asleep. Each scan counts as awake for all of
+ * sim_scan_us, which a real scan is not, so this is an upper bound.
+ */
+#include <stdio.h>
+
+#include "sim.h"
+#include "scan_sched.h"
+
+#ifndef SCAN_SCHEDULER_ENABLE
+#    error "Build the scheduler bench with SCAN_SCHEDULER_ENABLE=yes, as the Makefile does"
+#endif
+
+#define SESSION_MS (10 * 60 * 1000)
+#define HOLD_MS 90
+#define HALF_KEYS 5
+
+typedef struct {
+    uint32_t down_ms;
+    uint8_t  position;
+} press_t;
+
+static press_t  presses[SESSION_MS / 125 + 1];
+static uint16_t press_count;
+
+static uint32_t random_state;
+
+static uint32_t random_between(uint32_t low, uint32_t high) {
+    random_state = random_state * 1103515245 + 12345;
+    return low + (random_state >> 16) % (high - low + 1);
+}
+
+static bool primary_half(uint8_t position) {
+    return position < POS_R11;
+}
+
+static void make_session(void) {
+    uint32_t time = 1000;
+    random_state  = 1;
+    while (time < SESSION_MS - 20000) {
+        uint32_t burst_end = time + random_between(3000, 20000);
+        for (; time < burst_end; time += random_between(125, 375)) {
+            uint8_t key                 = random_between(0, 2 * HALF_KEYS - 1);
+            presses[press_count++] = (press_t){time, key < HALF_KEYS ? POS_L11 + key : POS_R11 + key - HALF_KEYS};
+        }
+        time += random_between(1000, 30000);
+    }
+}
+
+typedef enum { SLEEP_OFF, SLEEP_WAIT, SLEEP_EDGE } sleep_t;
+
+static struct {
+    sleep_t  sleep;
+    uint16_t interval_ms;
+    uint64_t start_us, slept_us;
+    uint32_t sleeps;
+    uint16_t next_edge; // First press whose edges on the primary half are still to come
+} row;
+
+// The next edge of the primary half's keys at or after now, if there is one before until.
+static uint64_t primary_edge_before(uint64_t now, uint64_t until) {
+    for (uint16_t i = row.next_edge; i < press_count; i++) {
+        uint64_t down = row.start_us + presses[i].down_ms * 1000ULL, up = down + HOLD_MS * 1000ULL;
+        if (down >= until) break;
+        if (!primary_half(presses[i].position)) continue;
+        if (down >= now) return down;
+        if (up >= now && up < until) return up;
+    }
+    return until;
+}
+
+void scan_sched_sleep(uint16_t timeout) {
+    if (row.sleep == SLEEP_OFF) return;
+    uint64_t now   = sim_now_us();
+    uint64_t until = now + row.interval_ms * 1000ULL;
+    if (row.sleep == SLEEP_EDGE) {
+        /* The harness counts a scan's time after the housekeeping, so the sleep ends a scan
+         * early for the next scan to fall on the edge, as it does on the keyboard.
+         */
+        uint64_t edge = primary_edge_before(now, until);
+        if (edge < until) until = edge > now + sim_scan_us ? edge - sim_scan_us : now;
+    }
+    row.slept_us += until - now;
+    row.sleeps++;
+    wait_us(until - now);
+}
+
+typedef struct {
+    uint64_t total_us, max_us;
+    uint32_t count;
+} lateness_t;
+
+static void run_row(const char *name, sleep_t sleep, uint16_t interval_ms) {
+    lateness_t late[2] = {0};
+    // The next press and the next release to come
+    uint16_t down = 0, up = 0;
+
+    sim_wait(2 * SCAN_IDLE_TIME);
+    row = (typeof(row)){.sleep = sleep, .interval_ms = interval_ms, .start_us = sim_now_us()};
+    while (down < press_count || up < press_count) {
+        bool     press = down < press_count && presses[down].down_ms < presses[up].down_ms + HOLD_MS;
+        uint64_t at    = row.start_us + (press ? presses[down].down_ms : presses[up].down_ms + HOLD_MS) * 1000ULL;
+        if (at > sim_now_us()) sim_wait_us(at - sim_now_us());
+        if (press) {
+            lateness_t *half = &late[!primary_half(presses[down].position)];
+            uint64_t    us   = sim_now_us() - at;
+            half->total_us += us;
+            half->max_us = us > half->max_us ? us : half->max_us;
+            half->count++;
+            sim_down(presses[down++].position);
+        } else {
+            sim_up(presses[up++].position);
+        }
+        row.next_edge = up;
+    }
+    sim_wait_us(row.start_us + SESSION_MS * 1000ULL - sim_now_us());
+
+    uint64_t total_us = sim_now_us() - row.start_us;
+    printf("%-5s %4u ms   %7.0f %7u   %7.0f %7u   %5.1f%% %9u\n", name, interval_ms, (double)late[0].total_us / late[0].count, (unsigned)late[0].max_us, (double)late[1].total_us / late[1].count, (unsigned)late[1].max_us,
+           100.0 * (total_us - row.slept_us) / total_us, (unsigned)row.sleeps);
+    sim_clear();
+}
+
+int main(void) {
+    sim_boot();
+    make_session();
+    printf("%u presses in %u s, scanned every %u us, idle after %u ms\n\n", press_count, SESSION_MS / 1000, (unsigned)sim_scan_us, SCAN_IDLE_TIME);
+    printf("           idle    press to scan, us\n");
+    printf("sleep  interval   primary max    secondary max   awake    sleeps\n");
+    run_row("off", SLEEP_OFF, 0);
+    run_row("wait", SLEEP_WAIT, 4);
+    run_row("edge", SLEEP_EDGE, 4);
+    run_row("edge", SLEEP_EDGE, 1);
+    return 0;
+}
@@ -0,0 +1,227 @@
+/* The secondary half's matrix over a simulated serial link: QMK's transport against a
+ * delta transport, with delayed transactions and dropped frames.
+ *
+ * A minute of typing on the secondary half (four keys a second, each held 90 ms, rolls
+ * included) is scanned every sim_scan_us plus the time the link takes that scan.
+ *  - qmk: what QMK's split transport does each scan, a one byte checksum of the
+ *    secondary matrix, then the 4 byte matrix in a second transaction when it changed.
+ *  - delta: one transaction per scan carrying a sequence number and the presses and
+ *    releases since the last frame, one byte each. The primary half asks for the full
+ *    matrix after a gap in the sequence numbers, and every 100 ms regardless.
+ * A dropped frame fails its transaction, as a parity error does on the soft serial link,
+ * and the secondary half cannot tell. The link is modeled, not measured: each byte is 10
+ * bit times, each transaction starts with a transaction id and a 2 byte turnaround, and
+ * the injected delay is added to every transaction.
+ *
+ * link us/scan: time on the link per scan, on average and on a scan that carries a change.
+ * stale: how long the primary half's copy of a key lags behind the secondary matrix.
+ * missed presses: keys released again before the primary half saw them go down.
+ */
+#include <stdio.h>
+
+#include "sim.h"
+
+#define SECONDARY_ROWS (MATRIX_ROWS / 2)
+#define SESSION_MS 60000
+#define PRESS_EVERY_MS 250
+#define HOLD_MS 90
+#define RESYNC_MS 100
+#define BYTE_BITS 10
+#define TURNAROUND_BYTES 2
+
+typedef struct {
+    uint32_t down_ms;
+    uint8_t  row, column;
+} press_t;
+
+static press_t presses[SESSION_MS / PRESS_EVERY_MS * 2];
+static uint16_t press_count;
+
+static uint32_t random_state = 1;
+
+static uint32_t random_below(uint32_t limit) {
+    random_state = random_state * 1103515245 + 12345;
+    return (random_state >> 16) % limit;
+}
+
+// Four presses a second on average, some of them starting before the last one is released.
+static void make_session(void) {
+    uint32_t time = 0;
+    press_count   = 0;
+    random_state  = 1;
+    while (time < SESSION_MS - HOLD_MS) {
+        uint8_t row = random_below(SECONDARY_ROWS);
+        press_t *press = &presses[press_count++];
+        press->down_ms = time;
+        press->row     = row;
+        press->column  = row == SECONDARY_ROWS - 1 ? random_below(2) : random_below(5);
+        time += PRESS_EVERY_MS / 2 + random_below(PRESS_EVERY_MS);
+    }
+}
+
+static void secondary_matrix(uint32_t ms, matrix_row_t matrix[SECONDARY_ROWS]) {
+    memset(matrix, 0, SECONDARY_ROWS * sizeof(matrix_row_t));
+    for (uint16_t i = 0; i < press_count; i++) {
+        if (ms >= presses[i].down_ms && ms < presses[i].down_ms + HOLD_MS) matrix[presses[i].row] |= (matrix_row_t)1 << presses[i].column;
+    }
+}
+
+typedef struct {
+    uint32_t bits_per_second;
+    uint32_t delay_us;
+    uint16_t drop_per_mille;
+} link_t;
+
+static double transaction_us(const link_t *link, uint8_t bytes) {
+    return (1 + TURNAROUND_BYTES + bytes) * BYTE_BITS * 1e6 / link->bits_per_second + link->delay_us;
+}
+
+static bool dropped(const link_t *link) {
+    return random_below(1000) < link->drop_per_mille;
+}
+
+// CRC-8 of the matrix, as QMK checksums it
+static uint8_t checksum(const matrix_row_t matrix[SECONDARY_ROWS]) {
+    uint8_t crc = 0xFF;
+    for (uint8_t row = 0; row < SECONDARY_ROWS; row++) {
+        crc ^= matrix[row];
+        for (uint8_t bit = 0; bit < 8; bit++) crc = crc & 0x80 ? (crc << 1) ^ 0x31 : crc << 1;
+    }
+    return crc;
+}
+
+static uint8_t changed_keys(const matrix_row_t a[SECONDARY_ROWS], const matrix_row_t b[SECONDARY_ROWS]) {
+    uint8_t count = 0;
+    for (uint8_t row = 0; row < SECONDARY_ROWS; row++) count += __builtin_popcount(a[row] ^ b[row]);
+    return count;
+}
+
+typedef struct {
+    double   link_us, change_link_us;
+    uint32_t scans, change_scans;
+    double   stale_us, stale_max_us;
+    uint32_t stale_keys, missed_presses;
+} result_t;
+
+// One scan's exchange: updates the primary half's copy and returns the time the link took.
+typedef double (*transport_t)(const link_t *link, uint32_t ms, const matrix_row_t secondary[SECONDARY_ROWS], matrix_row_t primary[SECONDARY_ROWS]);
+
+static double qmk_scan(const link_t *link, uint32_t ms, const matrix_row_t secondary[SECONDARY_ROWS], matrix_row_t primary[SECONDARY_ROWS]) {
+    double us = transaction_us(link, 1);
+    if (dropped(link)) return us;
+    if (checksum(secondary) == checksum(primary)) return us;
+    us += transaction_us(link, SECONDARY_ROWS * sizeof(matrix_row_t));
+    if (dropped(link)) return us;
+    memcpy(primary, secondary, SECONDARY_ROWS * sizeof(matrix_row_t));
+    return us;
+}
+
+static matrix_row_t delta_sent[SECONDARY_ROWS];
+static uint8_t      delta_sequence, delta_expected;
+static bool         delta_resync;
+static uint32_t     delta_resync_ms;
+
+static double delta_scan(const link_t *link, uint32_t ms, const matrix_row_t secondary[SECONDARY_ROWS], matrix_row_t primary[SECONDARY_ROWS]) {
+    if (ms - delta_resync_ms >= RESYNC_MS) delta_resync = true;
+    bool         full = delta_resync;
+    matrix_row_t delta[SECONDARY_ROWS];
+    for (uint8_t row = 0; row < SECONDARY_ROWS; row++) delta[row] = secondary[row] ^ delta_sent[row];
+    // The secondary half sends the frame and moves on, whether the primary half gets it or not.
+    uint8_t changes = changed_keys(secondary, delta_sent);
+    memcpy(delta_sent, secondary, sizeof(delta_sent));
+    uint8_t sequence = delta_sequence++;
+    double  us       = transaction_us(link, 1 + (full ? SECONDARY_ROWS * sizeof(matrix_row_t) : changes));
+    if (dropped(link)) return us;
+
+    if (full) {
+        memcpy(primary, secondary, SECONDARY_ROWS * sizeof(matrix_row_t));
+        delta_resync    = false;
+        delta_resync_ms = ms;
+    } else if (sequence != delta_expected) {
+        delta_resync = true; // A frame went missing, the primary half asks for the whole matrix next
+    } else {
+        for (uint8_t row = 0; row < SECONDARY_ROWS; row++) primary[row] ^= delta[row];
+    }
+    delta_expected = sequence + 1;
+    return us;
+}
+
+static result_t run(const link_t *link, transport_t transport) {
+    matrix_row_t secondary[SECONDARY_ROWS], primary[SECONDARY_ROWS] = {0}, last[SECONDARY_ROWS] = {0};
+    // Keys whose change the primary half has not seen yet, and when the secondary half scanned it
+    matrix_row_t pending[SECONDARY_ROWS] = {0};
+    double       changed_at[SECONDARY_ROWS][MATRIX_COLS];
+    result_t     result = {0};
+    memset(delta_sent, 0, sizeof(delta_sent));
+    delta_sequence = delta_expected = 0;
+    delta_resync    = false;
+    delta_resync_ms = 0;
+    random_state    = 7;
+
+    for (double us = 0; us < SESSION_MS * 1000.0;) {
+        secondary_matrix(us / 1000, secondary);
+        bool change = false;
+        for (uint8_t row = 0; row < SECONDARY_ROWS; row++) {
+            matrix_row_t changed = secondary[row] ^ last[row];
+            for (uint8_t column = 0; column < MATRIX_COLS; column++) {
+                if (!(changed >> column & 1)) continue;
+                change = true;
+                // Released before the primary half saw it go down
+                if ((pending[row] >> column & 1) && !(secondary[row] >> column & 1)) result.missed_presses++;
+                pending[row] |= (matrix_row_t)1 << column;
+                changed_at[row][column] = us;
+            }
+            last[row] = secondary[row];
+        }
+
+        double link_us = transport(link, us / 1000, secondary, primary);
+        us += link_us;
+        result.link_us += link_us;
+        result.scans++;
+        if (change) {
+            result.change_link_us += link_us;
+            result.change_scans++;
+        }
+        for (uint8_t row = 0; row < SECONDARY_ROWS; row++) {
+            matrix_row_t arrived = pending[row] & ~(primary[row] ^ secondary[row]);
+            for (uint8_t column = 0; column < MATRIX_COLS; column++) {
+                if (!(arrived >> column & 1)) continue;
+                double stale = us - changed_at[row][column];
+                result.stale_us += stale;
+                result.stale_keys++;
+                if (stale > result.stale_max_us) result.stale_max_us = stale;
+            }
+            pending[row] &= ~arrived;
+        }
+        us += sim_scan_us;
+    }
+    return result;
+}
+
+static void print_row(const char *name, const link_t *link, transport_t transport) {
+    result_t result = run(link, transport);
+    printf("%-6s %6u %5u %5u.%u%%   %7.1f %7.1f   %7.0f %7.0f %7u\n", name, (unsigned)(link->bits_per_second / 1000), (unsigned)link->delay_us, link->drop_per_mille / 10, link->drop_per_mille % 10,
+           result.link_us / result.scans, result.change_link_us / result.change_scans, result.stale_us / result.stale_keys, result.stale_max_us, (unsigned)result.missed_presses);
+}
+
+int main(void) {
+    // About the rates of SELECT_SOFT_SERIAL_SPEED 0, 1 (QMK's default) and 2
+    static const uint32_t speeds[] = {189000, 137000, 75000};
+    static const uint32_t delays[] = {0, 20};
+    static const uint16_t drops[]  = {0, 10, 50};
+
+    make_session();
+    printf("%u presses on the secondary half, scanned every %u us plus the link\n\n", press_count, (unsigned)sim_scan_us);
+    printf("         kbps delay  drop     link us/scan       stale us     missed\n");
+    printf("                                avg  change      avg     max  presses\n");
+    for (uint8_t s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++) {
+        for (uint8_t d = 0; d < sizeof(delays) / sizeof(delays[0]); d++) {
+            for (uint8_t p = 0; p < sizeof(drops) / sizeof(drops[0]); p++) {
+                link_t link = {speeds[s], delays[d], drops[p]};
+                print_row("qmk", &link, qmk_scan);
+                print_row("delta", &link, delta_scan);
+            }
+        }
+    }
+    return 0;
+}
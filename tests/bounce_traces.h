@@ -0,0 +1,47 @@
+#ifndef FERRIS_SWEEP_BOUNCE_TRACES_H
+#define FERRIS_SWEEP_BOUNCE_TRACES_H
+
+/* Contact bounce traces for test_debounce.c.
+ *
+ * These are synthetic, written to the shapes a scope shows for MX style switches:
+ * a few hundred µs of bounce on a clean press, up to about 5 ms on a worn one, bounce
+ * on release as well, and single short spikes from noise or a rattled key. None of
+ * them is a recording. Add real ones as they turn up, in the same form.
+ *
+ * Each trace is the times in µs at which the contact flips, starting open. A trace
+ * ends open. The counts are the presses each policy in debounce.c must report for it:
+ * an eager key registers a spike as a short press, a deferred one never does.
+ */
+
+#include <stdint.h>
+
+typedef struct {
+    const char     *name;
+    uint8_t         eager_presses;
+    uint8_t         deferred_presses;
+    uint8_t         edge_count;
+    const uint32_t *edges;
+} bounce_trace_t;
+
+#define BOUNCE_TRACE(name, eager, deferred, ...) \
+    {name, eager, deferred, sizeof((const uint32_t[]){__VA_ARGS__}) / sizeof(uint32_t), (const uint32_t[]){__VA_ARGS__}}
+
+static const bounce_trace_t bounce_traces[] = {
+    BOUNCE_TRACE("clean press", 1, 1, 10000, 60000),
+    BOUNCE_TRACE("press bouncing 300 us", 1, 1, 10000, 10080, 10150, 10230, 10300, 60000),
+    BOUNCE_TRACE("press bouncing 1 ms", 1, 1, 10000, 10120, 10250, 10500, 11000, 60000),
+    BOUNCE_TRACE("press bouncing 4 ms", 1, 1, 10000, 10300, 10800, 11500, 12000, 13100, 14000, 60000),
+    BOUNCE_TRACE("release bouncing 1 ms", 1, 1, 10000, 60000, 60200, 60400, 60700, 61000),
+    BOUNCE_TRACE("release bouncing 4 ms", 1, 1, 10000, 60000, 60500, 61000, 62000, 62600, 63200, 64000),
+    BOUNCE_TRACE("worn switch, both edges 5 ms", 1, 1, 10000, 10400, 11000, 12000, 12500, 13500, 15000, 60000, 60700, 61500, 62300, 63000, 64100, 65000),
+    BOUNCE_TRACE("quick tap, 15 ms", 1, 1, 10000, 10200, 10400, 25000, 25300, 25600),
+    BOUNCE_TRACE("press with a leading touch", 1, 1, 10000, 10100, 12000, 12200, 12400, 60000),
+    BOUNCE_TRACE("dropout while held", 1, 1, 10000, 35000, 35400, 60000),
+    BOUNCE_TRACE("noise spike, 200 us", 1, 0, 10000, 10200),
+    BOUNCE_TRACE("noise spike, 1 ms", 1, 0, 10000, 11000),
+    BOUNCE_TRACE("double tap, 40 ms apart", 2, 2, 10000, 10300, 10500, 30000, 30400, 30600, 50000, 50200, 50400, 70000, 70300, 70500),
+};
+
+#define BOUNCE_TRACE_COUNT (sizeof(bounce_traces) / sizeof(bounce_traces[0]))
+
+#endif
@@ -0,0 +1,8 @@
+/* Host stand-in for QMK's debounce API, see quantum.h. */
+#pragma once
+
+#include "quantum.h"
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+void debounce_init(uint8_t num_rows);
+void debounce_free(void);
@@ -0,0 +1,359 @@
+/* Host stand-in for QMK_KEYBOARD_H, the parts of QMK's API this keymap uses.
+ *
+ * Types, keycode values and macros follow QMK 0.2x, so the keymap sources build
+ * unchanged. The functions are implemented by sim.c. Only what the keymap touches is
+ * here, anything new it starts using has to be added.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+#define pgm_read_ptr(address) (*(void *const *)(address))
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#ifndef MIN
+#    define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#    define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+/* Ferris Sweep matrix: each half is 4 rows of 5 columns, the right half's rows come
+ * after the left half's and its columns run from the outside in.
+ */
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 5
+
+// clang-format off
+#define LAYOUT_split_3x5_2( \
+    k00, k01, k02, k03, k04,    k44, k43, k42, k41, k40, \
+    k10, k11, k12, k13, k14,    k54, k53, k52, k51, k50, \
+    k20, k21, k22, k23, k24,    k64, k63, k62, k61, k60, \
+                   k33, k34,    k74, k73 \
+) { \
+    {k00, k01, k02, k03, k04}, \
+    {k10, k11, k12, k13, k14}, \
+    {k20, k21, k22, k23, k24}, \
+    {0,   0,   0,   k33, k34}, \
+    {k40, k41, k42, k43, k44}, \
+    {k50, k51, k52, k53, k54}, \
+    {k60, k61, k62, k63, k64}, \
+    {0,   0,   0,   k73, k74}  \
+}
+// clang-format on
+
+#ifndef TAPPING_TERM
+#    define TAPPING_TERM 200
+#endif
+#ifndef QUICK_TAP_TERM
+#    define QUICK_TAP_TERM TAPPING_TERM
+#endif
+#ifndef EECONFIG_USER_DATA_SIZE
+#    define EECONFIG_USER_DATA_SIZE 0
+#endif
+// Address of the user datablock in the emulated EEPROM
+#define EECONFIG_USER_DATABLOCK ((uint8_t *)64)
+
+/* Timer */
+
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+uint16_t sync_timer_read(void);
+uint32_t sync_timer_read32(void);
+void     wait_ms(uint16_t ms);
+void     wait_us(uint16_t us);
+uint32_t last_input_activity_elapsed(void);
+uint32_t last_matrix_activity_elapsed(void);
+
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+#define TIMER_DIFF_32(a, b) ((uint32_t)((a) - (b)))
+#define timer_expired(current, future) ((uint16_t)(current - future) < UINT16_MAX / 2)
+
+/* Matrix and split */
+
+typedef uint8_t matrix_row_t;
+
+matrix_row_t matrix_get_row(uint8_t row);
+bool         matrix_is_on(uint8_t row, uint8_t col);
+bool         is_keyboard_master(void);
+bool         is_keyboard_left(void);
+
+/* Key events */
+
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+typedef enum keyevent_type_t { TICK_EVENT = 0, KEY_EVENT = 1, ENCODER_CW_EVENT = 2, ENCODER_CCW_EVENT = 3, COMBO_EVENT = 4 } keyevent_type_t;
+
+typedef struct {
+    keypos_t        key;
+    uint16_t        time;
+    keyevent_type_t type;
+    bool            pressed;
+} keyevent_t;
+
+typedef struct {
+    bool    interrupted : 1;
+    bool    reserved2 : 1;
+    bool    reserved1 : 1;
+    bool    reserved0 : 1;
+    uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+    keyevent_t event;
+    tap_t      tap;
+    uint16_t   keycode;
+} keyrecord_t;
+
+#define KEYEQ(keya, keyb) ((keya).row == (keyb).row && (keya).col == (keyb).col)
+#define MAKE_KEYPOS(row_num, col_num) ((keypos_t){.row = (row_num), .col = (col_num)})
+#define MAKE_KEYEVENT(row_num, col_num, press) ((keyevent_t){.key = MAKE_KEYPOS((row_num), (col_num)), .pressed = (press), .time = (timer_read() | 1), .type = KEY_EVENT})
+#define MAKE_TICK_EVENT ((keyevent_t){.time = (timer_read() | 1), .type = TICK_EVENT})
+
+static inline bool IS_NOEVENT(const keyevent_t event) {
+    return event.type == TICK_EVENT;
+}
+static inline bool IS_EVENT(const keyevent_t event) {
+    return event.type != TICK_EVENT;
+}
+
+void action_exec(keyevent_t event);
+
+/* Layers */
+
+typedef uint32_t layer_state_t;
+
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+uint8_t       get_highest_layer(layer_state_t state);
+bool          layer_state_is(uint8_t layer);
+bool          layer_state_cmp(layer_state_t state, uint8_t layer);
+void          layer_on(uint8_t layer);
+void          layer_off(uint8_t layer);
+void          layer_move(uint8_t layer);
+void          layer_clear(void);
+layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3);
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+uint16_t              keycode_at_keymap_location(uint8_t layer_num, uint8_t row, uint8_t column);
+
+/* Keycodes */
+
+// clang-format off
+enum qk_keycode_defines {
+    KC_NO = 0x0000, KC_TRNS = 0x0001,
+    KC_A = 0x0004, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M,
+    KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z,
+    KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0,
+    KC_ENT, KC_ESC, KC_BSPC, KC_TAB, KC_SPC, KC_MINS, KC_EQL, KC_LBRC, KC_RBRC, KC_BSLS,
+    KC_NUHS, KC_SCLN, KC_QUOT, KC_GRV, KC_COMM, KC_DOT, KC_SLSH, KC_CAPS,
+    KC_F1, KC_F2, KC_F3, KC_F4, KC_F5, KC_F6, KC_F7, KC_F8, KC_F9, KC_F10, KC_F11, KC_F12,
+    KC_PSCR, KC_SCRL, KC_PAUS, KC_INS, KC_HOME, KC_PGUP, KC_DEL, KC_END, KC_PGDN,
+    KC_RGHT, KC_LEFT, KC_DOWN, KC_UP,
+    KC_UNDO = 0x007A, KC_CUT, KC_COPY, KC_PSTE,
+    KC_MUTE = 0x00A8, KC_VOLU, KC_VOLD, KC_MNXT, KC_MPRV, KC_MSTP, KC_MPLY,
+    KC_MFFD = 0x00BB, KC_MRWD, KC_BRIU, KC_BRID,
+    KC_MS_U = 0x00CD, KC_MS_D, KC_MS_L, KC_MS_R,
+    KC_BTN1, KC_BTN2, KC_BTN3, KC_BTN4, KC_BTN5, KC_BTN6, KC_BTN7, KC_BTN8,
+    KC_WH_U, KC_WH_D, KC_WH_L, KC_WH_R,
+    KC_LCTL = 0x00E0, KC_LSFT, KC_LALT, KC_LGUI, KC_RCTL, KC_RSFT, KC_RALT, KC_RGUI,
+};
+// clang-format on
+
+#define XXXXXXX KC_NO
+#define _______ KC_TRNS
+
+#define QK_BASIC_MAX 0x00FF
+#define QK_MODS 0x0100
+#define QK_LCTL 0x0100
+#define QK_LSFT 0x0200
+#define QK_LALT 0x0400
+#define QK_LGUI 0x0800
+#define QK_RMODS_MIN 0x1000
+#define QK_MODS_MAX 0x1FFF
+#define QK_MOD_TAP 0x2000
+#define QK_MOD_TAP_MAX 0x3FFF
+#define QK_LAYER_TAP 0x4000
+#define QK_LAYER_TAP_MAX 0x4FFF
+#define QK_TAP_DANCE 0x5700
+#define QK_TAP_DANCE_MAX 0x57FF
+#define QK_BOOT 0x7C00
+#define QK_USER 0x7E40
+#define SAFE_RANGE QK_USER
+
+#define IS_BASIC_KEYCODE(code) ((code) >= KC_A && (code) <= 0x00A4)
+#define IS_CONSUMER_KEYCODE(code) ((code) >= KC_MUTE && (code) <= 0x00C6)
+#define IS_MOUSE_KEYCODE(code) ((code) >= KC_MS_U && (code) <= 0x00DF)
+#define IS_MOUSEKEY_BUTTON(code) ((code) >= KC_BTN1 && (code) <= KC_BTN8)
+#define IS_MODIFIER_KEYCODE(code) ((code) >= KC_LCTL && (code) <= KC_RGUI)
+#define IS_QK_MODS(code) ((code) >= QK_MODS && (code) <= QK_MODS_MAX)
+#define IS_QK_MOD_TAP(code) ((code) >= QK_MOD_TAP && (code) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(code) ((code) >= QK_LAYER_TAP && (code) <= QK_LAYER_TAP_MAX)
+#define IS_QK_TAP_DANCE(code) ((code) >= QK_TAP_DANCE && (code) <= QK_TAP_DANCE_MAX)
+
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+#define MOD_RCTL 0x11
+#define MOD_RSFT 0x12
+#define MOD_RALT 0x14
+#define MOD_RGUI 0x18
+
+#define MOD_BIT(code) (1 << ((code)&0x07))
+#define MOD_MASK_CTRL (MOD_BIT(KC_LCTL) | MOD_BIT(KC_RCTL))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+#define MOD_MASK_ALT (MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT))
+#define MOD_MASK_GUI (MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI))
+
+#define LCTL(kc) (QK_LCTL | (kc))
+#define LSFT(kc) (QK_LSFT | (kc))
+#define LALT(kc) (QK_LALT | (kc))
+#define LGUI(kc) (QK_LGUI | (kc))
+#define QK_MODS_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MODS_GET_BASIC_KEYCODE(kc) ((kc)&0xFF)
+
+#define MT(mod, kc) (QK_MOD_TAP | (((mod)&0x1F) << 8) | ((kc)&0xFF))
+#define LCTL_T(kc) MT(MOD_LCTL, kc)
+#define LSFT_T(kc) MT(MOD_LSFT, kc)
+#define LALT_T(kc) MT(MOD_LALT, kc)
+#define LGUI_T(kc) MT(MOD_LGUI, kc)
+#define RCTL_T(kc) MT(MOD_RCTL, kc)
+#define RSFT_T(kc) MT(MOD_RSFT, kc)
+#define RALT_T(kc) MT(MOD_RALT, kc)
+#define RGUI_T(kc) MT(MOD_RGUI, kc)
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc)&0xFF)
+
+#define LT(layer, kc) (QK_LAYER_TAP | (((layer)&0xF) << 8) | ((kc)&0xFF))
+#define QK_LAYER_TAP_GET_LAYER(kc) (((kc) >> 8) & 0xF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc)&0xFF)
+
+#define TD(i) (QK_TAP_DANCE | ((i)&0xFF))
+#define QK_TAP_DANCE_GET_INDEX(kc) ((kc)&0xFF)
+
+#define KC_EXLM LSFT(KC_1)
+#define KC_AT LSFT(KC_2)
+#define KC_HASH LSFT(KC_3)
+#define KC_DLR LSFT(KC_4)
+#define KC_PERC LSFT(KC_5)
+#define KC_CIRC LSFT(KC_6)
+#define KC_AMPR LSFT(KC_7)
+#define KC_ASTR LSFT(KC_8)
+#define KC_LPRN LSFT(KC_9)
+#define KC_RPRN LSFT(KC_0)
+#define KC_UNDS LSFT(KC_MINS)
+#define KC_PLUS LSFT(KC_EQL)
+#define KC_LCBR LSFT(KC_LBRC)
+#define KC_RCBR LSFT(KC_RBRC)
+#define KC_PIPE LSFT(KC_BSLS)
+#define KC_COLN LSFT(KC_SCLN)
+#define KC_DQUO LSFT(KC_QUOT)
+#define KC_TILD LSFT(KC_GRV)
+#define KC_LT LSFT(KC_COMM)
+#define KC_GT LSFT(KC_DOT)
+#define KC_QUES LSFT(KC_SLSH)
+
+/* Reports and modifiers */
+
+#define KEYBOARD_REPORT_KEYS 6
+
+typedef struct {
+    uint8_t mods;
+    uint8_t reserved;
+    uint8_t keys[KEYBOARD_REPORT_KEYS];
+} report_keyboard_t;
+
+typedef struct {
+    uint8_t buttons;
+    int8_t  x;
+    int8_t  y;
+    int8_t  v;
+    int8_t  h;
+} report_mouse_t;
+
+enum mouse_buttons {
+    MOUSE_BTN1 = (1 << 0),
+    MOUSE_BTN2 = (1 << 1),
+    MOUSE_BTN3 = (1 << 2),
+};
+
+extern report_keyboard_t *keyboard_report;
+
+uint8_t get_mods(void);
+void    add_mods(uint8_t mods);
+void    del_mods(uint8_t mods);
+void    set_mods(uint8_t mods);
+void    clear_mods(void);
+uint8_t get_weak_mods(void);
+void    add_weak_mods(uint8_t mods);
+void    del_weak_mods(uint8_t mods);
+void    set_weak_mods(uint8_t mods);
+void    clear_weak_mods(void);
+uint8_t get_oneshot_mods(void);
+void    add_key(uint8_t key);
+void    del_key(uint8_t key);
+void    send_keyboard_report(void);
+
+void register_code(uint8_t code);
+void unregister_code(uint8_t code);
+void tap_code(uint8_t code);
+void register_code16(uint16_t code);
+void unregister_code16(uint16_t code);
+void tap_code16(uint16_t code);
+void register_mods(uint8_t mods);
+void unregister_mods(uint8_t mods);
+void register_weak_mods(uint8_t mods);
+void unregister_weak_mods(uint8_t mods);
+void do_code16(uint16_t code, void (*f)(uint8_t));
+
+report_mouse_t mousekey_get_report(void);
+void           host_mouse_send(report_mouse_t *report);
+
+/* Tap dance */
+
+typedef struct {
+    uint16_t interrupting_keycode;
+    uint8_t  count;
+    uint8_t  weak_mods;
+    uint8_t  oneshot_mods;
+    bool     pressed : 1;
+    bool     finished : 1;
+    bool     interrupted : 1;
+} tap_dance_state_t;
+
+typedef void (*tap_dance_user_fn_t)(tap_dance_state_t *state, void *user_data);
+
+typedef struct {
+    tap_dance_state_t state;
+    struct {
+        tap_dance_user_fn_t on_each_tap;
+        tap_dance_user_fn_t on_dance_finished;
+        tap_dance_user_fn_t on_reset;
+        tap_dance_user_fn_t on_each_release;
+    } fn;
+    void *user_data;
+} tap_dance_action_t;
+
+extern tap_dance_action_t tap_dance_actions[];
+
+/* EEPROM and console */
+
+void eeprom_read_block(void *buf, const void *addr, size_t len);
+void eeprom_update_block(const void *buf, void *addr, size_t len);
+
+void uprintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+#define dprintf uprintf
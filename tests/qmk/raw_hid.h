@@ -0,0 +1,7 @@
+/* Host stand-in for QMK's raw HID API, see quantum.h. */
+#pragma once
+
+#include "quantum.h"
+
+void raw_hid_receive(uint8_t *data, uint8_t length);
+void raw_hid_send(uint8_t *data, uint8_t length);
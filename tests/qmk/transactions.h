@@ -0,0 +1,14 @@
+/* Host stand-in for QMK's split transactions, see quantum.h. */
+#pragma once
+
+#include "quantum.h"
+
+// QMK generates these from SPLIT_TRANSACTION_IDS_USER.
+enum serial_transaction_id_user {
+    RPC_ID_USER_SPLIT_TIME = 0x40,
+};
+
+typedef void (*slave_callback_t)(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback);
+bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
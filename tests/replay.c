@@ -0,0 +1,76 @@
+/* Play a recorded typing session back through the keymap on the host harness.
+ *
+ *   build/event_log/replay sessions/name.txt > run.txt
+ *
+ * A session is what tools/event_log.py --session makes of a capture taken with the
+ * LOG_LIVE key. The key events go to the keymap at their recorded times on the virtual
+ * clock, so a run is the same every time, and the event log is printed as the keyboard
+ * streams it. tools/event_log.py --golden then compares a run with a golden one.
+ * `make check` does that for every session in sessions/.
+ *
+ * Exits with 1 when a key or modifier is still in the report once every key is up and
+ * the last tapping terms have run out: something was registered and never unregistered.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+#include "event_log.h"
+
+#ifndef EVENT_LOG_ENABLE
+#    error "The replay prints the event log, build it with EVENT_LOG_ENABLE=yes as the Makefile does"
+#endif
+
+static uint8_t layout_position(unsigned row, unsigned column) {
+    for (uint8_t position = 0; position < LAYOUT_KEY_COUNT; position++) {
+        keypos_t key = sim_key(position);
+        if (key.row == row && key.col == column) return position;
+    }
+    return LAYOUT_KEY_COUNT;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s session.txt\n", argv[0]);
+        return 2;
+    }
+    FILE *session = fopen(argv[1], "r");
+    if (!session) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    sim_boot();
+    sim_console_echo = true;
+    event_log_stream(true);
+    uint64_t start = sim_now_us();
+    char     line[256];
+    for (unsigned number = 1; fgets(line, sizeof(line), session); number++) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        unsigned long ms;
+        char          edge[5];
+        unsigned      row, column;
+        uint8_t       position = LAYOUT_KEY_COUNT;
+        if (sscanf(line, "%lu %4s r%uc%u", &ms, edge, &row, &column) == 4) position = layout_position(row, column);
+        if (position == LAYOUT_KEY_COUNT || (strcmp(edge, "down") && strcmp(edge, "up"))) {
+            fprintf(stderr, "%s:%u: expected \"<ms> down|up r<row>c<column>\" for a key of the layout\n", argv[1], number);
+            return 2;
+        }
+        uint64_t at = start + ms * 1000ULL;
+        if (at > sim_now_us()) sim_wait_us(at - sim_now_us());
+        if (!strcmp(edge, "down")) {
+            sim_down(position);
+        } else {
+            sim_up(position);
+        }
+    }
+    fclose(session);
+
+    // Long enough for the last dance to resolve and for the event log to flag a stuck report.
+    sim_wait(EVENT_LOG_STUCK_TERM + TAPPING_TERM);
+    if (!sim_report_empty()) {
+        fprintf(stderr, "%s: the report still holds mods 0x%02X or keys once every key is up\n", argv[1], sim_mods());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,1127 @@
+/* QMK's core as seen by the keymap, on a virtual clock, see sim.h.
+ *
+ * The tapping and tap dance code below follows quantum/action_tapping.c and
+ * quantum/process_keycode/process_tap_dance.c in QMK 0.2x, minus the features this
+ * keymap does not enable (retro tapping, auto shift, combos, one shot keys).
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "raw_hid.h"
+#include "tap_dance.h"
+#include "transactions.h"
+#ifdef SCAN_SCHEDULER_ENABLE
+#    include "scan_sched.h"
+#endif
+
+/* Clock */
+
+static uint64_t now_us;
+static uint64_t input_activity_us;
+uint32_t        sim_scan_us = 500;
+
+uint64_t sim_now_us(void) {
+    return now_us;
+}
+
+uint16_t timer_read(void) {
+    return now_us / 1000;
+}
+
+uint32_t timer_read32(void) {
+    return now_us / 1000;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return TIMER_DIFF_32(timer_read32(), last);
+}
+
+uint16_t sync_timer_read(void) {
+    return timer_read();
+}
+
+uint32_t sync_timer_read32(void) {
+    return timer_read32();
+}
+
+void wait_ms(uint16_t ms) {
+    now_us += ms * 1000ULL;
+}
+
+void wait_us(uint16_t us) {
+    now_us += us;
+}
+
+#ifdef SCAN_SCHEDULER_ENABLE
+// No key pins to wake on: the idle sleep takes the whole timeout. bench_scan_sched.c brings one that wakes.
+__attribute__((weak)) void scan_sched_sleep(uint16_t timeout) {
+    wait_ms(timeout);
+}
+#endif
+
+uint32_t last_input_activity_elapsed(void) {
+    return (now_us - input_activity_us) / 1000;
+}
+
+uint32_t last_matrix_activity_elapsed(void) {
+    return last_input_activity_elapsed();
+}
+
+/* Matrix and split, the primary half is the left one */
+
+static matrix_row_t matrix[MATRIX_ROWS];
+
+matrix_row_t matrix_get_row(uint8_t row) {
+    return matrix[row];
+}
+
+bool matrix_is_on(uint8_t row, uint8_t col) {
+    return matrix[row] & ((matrix_row_t)1 << col);
+}
+
+bool is_keyboard_master(void) {
+    return true;
+}
+
+bool is_keyboard_left(void) {
+    return true;
+}
+
+// No secondary half answers, split_time.c keeps the arrival times.
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback) {}
+
+bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    return false;
+}
+
+// Layout position + 1 of each matrix position, as in sparse_layers.c.
+#define P(position) (POS_##position + 1)
+static const uint8_t layout_index[MATRIX_ROWS][MATRIX_COLS] = LAYOUT_split_3x5_2(
+    P(L11), P(L12), P(L13), P(L14), P(L15), P(R11), P(R12), P(R13), P(R14), P(R15),
+    P(L21), P(L22), P(L23), P(L24), P(L25), P(R21), P(R22), P(R23), P(R24), P(R25),
+    P(L31), P(L32), P(L33), P(L34), P(L35), P(R31), P(R32), P(R33), P(R34), P(R35),
+                                    P(L41), P(L42), P(R41), P(R42)
+);
+#undef P
+
+keypos_t sim_key(uint8_t position) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (layout_index[row][col] == position + 1) return MAKE_KEYPOS(row, col);
+        }
+    }
+    fprintf(stderr, "no key at layout position %u\n", position);
+    abort();
+}
+
+/* User hooks the keymap does not define */
+
+__attribute__((weak)) bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+__attribute__((weak)) bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+__attribute__((weak)) void post_process_record_user(uint16_t keycode, keyrecord_t *record) {}
+__attribute__((weak)) layer_state_t layer_state_set_user(layer_state_t state) {
+    return state;
+}
+__attribute__((weak)) layer_state_t default_layer_state_set_user(layer_state_t state) {
+    return state;
+}
+__attribute__((weak)) void keyboard_post_init_user(void) {}
+__attribute__((weak)) void matrix_scan_user(void) {}
+__attribute__((weak)) void housekeeping_task_user(void) {}
+__attribute__((weak)) uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+    return TAPPING_TERM;
+}
+__attribute__((weak)) uint16_t get_quick_tap_term(uint16_t keycode, keyrecord_t *record) {
+    return QUICK_TAP_TERM;
+}
+__attribute__((weak)) bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) {
+    return false;
+}
+__attribute__((weak)) bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) {
+    return false;
+}
+
+/* Layers */
+
+layer_state_t layer_state;
+layer_state_t default_layer_state;
+
+uint8_t get_highest_layer(layer_state_t state) {
+    return state ? 31 - __builtin_clz(state) : 0;
+}
+
+bool layer_state_cmp(layer_state_t state, uint8_t layer) {
+    if (!state) return layer == 0;
+    return state & ((layer_state_t)1 << layer);
+}
+
+bool layer_state_is(uint8_t layer) {
+    return layer_state_cmp(layer_state, layer);
+}
+
+static void layer_state_set(layer_state_t state) {
+    layer_state = layer_state_set_user(state);
+}
+
+void layer_on(uint8_t layer) {
+    layer_state_set(layer_state | ((layer_state_t)1 << layer));
+}
+
+void layer_off(uint8_t layer) {
+    layer_state_set(layer_state & ~((layer_state_t)1 << layer));
+}
+
+void layer_move(uint8_t layer) {
+    layer_state_set((layer_state_t)1 << layer);
+}
+
+void layer_clear(void) {
+    layer_state_set(0);
+}
+
+layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3) {
+    layer_state_t mask12 = ((layer_state_t)1 << layer1) | ((layer_state_t)1 << layer2);
+    layer_state_t mask3  = (layer_state_t)1 << layer3;
+    return (state & mask12) == mask12 ? (state | mask3) : (state & ~mask3);
+}
+
+// Layer each pressed key was looked up on, so its release goes to the same keycode
+static uint8_t source_layers[MATRIX_ROWS][MATRIX_COLS];
+
+static uint8_t layer_switch_get_layer(keypos_t key) {
+    layer_state_t layers = layer_state | default_layer_state;
+    for (int8_t i = 31; i >= 0; i--) {
+        if ((layers & ((layer_state_t)1 << i)) && keycode_at_keymap_location(i, key.row, key.col) != KC_TRNS) return i;
+    }
+    return 0;
+}
+
+static uint16_t layer_switch_get_keycode(keypos_t key) {
+    return keycode_at_keymap_location(layer_switch_get_layer(key), key.row, key.col);
+}
+
+static uint16_t get_event_keycode(keyevent_t event, bool update_layer_cache) {
+    uint8_t layer;
+    if (event.pressed && update_layer_cache) {
+        layer                                     = layer_switch_get_layer(event.key);
+        source_layers[event.key.row][event.key.col] = layer;
+    } else {
+        layer = source_layers[event.key.row][event.key.col];
+    }
+    return keycode_at_keymap_location(layer, event.key.row, event.key.col);
+}
+
+static uint16_t get_record_keycode(keyrecord_t *record, bool update_layer_cache) {
+    return get_event_keycode(record->event, update_layer_cache);
+}
+
+uint16_t sim_keycode(uint8_t position) {
+    return layer_switch_get_keycode(sim_key(position));
+}
+
+/* Latency: each press to the first report that adds a key or modifier after it */
+
+enum sim_latency_classes {
+    SIM_PLAIN,
+    SIM_MOD_TAP,
+    SIM_LAYER_TAP,
+    SIM_DANCE, // One class per tap dance from here
+    SIM_CLASS_COUNT = SIM_DANCE + TAP_DANCE_COUNT
+};
+
+#define SIM_DANCE_NAME(dance, ...) "TD(" #dance ")",
+
+static const char *const class_names[SIM_CLASS_COUNT] = {"plain", "mod-tap", "layer-tap", TAP_DANCE_TABLE(SIM_DANCE_NAME)};
+
+static struct {
+    uint32_t count;
+    uint64_t total_us;
+    uint64_t max_us;
+} latency[SIM_CLASS_COUNT];
+
+static struct {
+    bool     pending;
+    bool     processed;
+    uint8_t  class;
+    uint64_t pressed_us;
+} presses[LAYOUT_KEY_COUNT];
+
+static uint8_t latency_class(uint16_t keycode) {
+    if (IS_QK_TAP_DANCE(keycode) && QK_TAP_DANCE_GET_INDEX(keycode) < TAP_DANCE_COUNT) return SIM_DANCE + QK_TAP_DANCE_GET_INDEX(keycode);
+    if (IS_QK_MOD_TAP(keycode)) return SIM_MOD_TAP;
+    if (IS_QK_LAYER_TAP(keycode)) return SIM_LAYER_TAP;
+    return SIM_PLAIN;
+}
+
+// QMK processes the press, the keycode it settled on gives the class.
+static void latency_processed(keyrecord_t *record, uint16_t keycode) {
+    uint8_t position = layout_index[record->event.key.row][record->event.key.col] - 1;
+    if (!record->event.pressed || position >= LAYOUT_KEY_COUNT || !presses[position].pending) return;
+    presses[position].class     = latency_class(keycode);
+    presses[position].processed = true;
+}
+
+static void latency_cancel(keypos_t key) {
+    uint8_t position = layout_index[key.row][key.col] - 1;
+    if (position < LAYOUT_KEY_COUNT) presses[position].pending = false;
+}
+
+static void latency_report(void) {
+    for (uint8_t i = 0; i < LAYOUT_KEY_COUNT; i++) {
+        if (!presses[i].pending) continue;
+        uint64_t elapsed = now_us - presses[i].pressed_us;
+        latency[presses[i].class].count++;
+        latency[presses[i].class].total_us += elapsed;
+        latency[presses[i].class].max_us = MAX(latency[presses[i].class].max_us, elapsed);
+        presses[i].pending               = false;
+    }
+}
+
+void sim_latency_print(void) {
+    printf("%-28s %8s %8s %8s\n", "class", "presses", "avg ms", "max ms");
+    for (uint8_t i = 0; i < SIM_CLASS_COUNT; i++) {
+        if (!latency[i].count) continue;
+        printf("%-28s %8u %8.1f %8.1f\n", class_names[i], latency[i].count, latency[i].total_us / 1000.0 / latency[i].count, latency[i].max_us / 1000.0);
+    }
+}
+
+/* Keyboard and mouse reports */
+
+sim_report_t   sim_reports[SIM_MAX_REPORTS];
+uint16_t       sim_report_count;
+uint16_t       sim_mouse_report_count;
+report_mouse_t sim_mouse_last;
+
+static report_keyboard_t report;
+static report_keyboard_t last_report;
+report_keyboard_t       *keyboard_report = &report;
+static uint8_t           real_mods;
+static uint8_t           weak_mods;
+static uint8_t           mouse_buttons;
+
+static char   typed[16384];
+static size_t typed_length;
+
+static void type_text(const char *text) {
+    size_t length = strlen(text);
+    if (typed_length + length >= sizeof(typed)) return;
+    memcpy(typed + typed_length, text, length + 1);
+    typed_length += length;
+}
+
+static const char *key_name(uint8_t code) {
+    static char name[8];
+    switch (code) {
+        // clang-format off
+        case KC_ESC: return "esc";   case KC_BSPC: return "bs";    case KC_CAPS: return "caps";
+        case KC_INS: return "ins";   case KC_DEL: return "del";    case KC_HOME: return "home";
+        case KC_END: return "end";   case KC_PGUP: return "pgup";  case KC_PGDN: return "pgdn";
+        case KC_LEFT: return "left"; case KC_RGHT: return "right"; case KC_UP: return "up";
+        case KC_DOWN: return "down"; case KC_UNDO: return "undo";  case KC_CUT: return "cut";
+        case KC_COPY: return "copy"; case KC_PSTE: return "paste";
+        // clang-format on
+    }
+    if (code >= KC_F1 && code <= KC_F12) {
+        snprintf(name, sizeof(name), "f%u", code - KC_F1 + 1);
+    } else {
+        snprintf(name, sizeof(name), "0x%02x", code);
+    }
+    return name;
+}
+
+// Characters typed by KC_A to KC_SLSH, without and with Shift
+static const char *const key_chars[2] = {
+    "abcdefghijklmnopqrstuvwxyz1234567890\n\x1b\b\t -=[]\\#;'`,./",
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%^&*()\n\x1b\b\t _+{}|~:\"~<>?",
+};
+
+static void type_key(uint8_t code, uint8_t mods) {
+    bool shift     = mods & MOD_MASK_SHIFT;
+    bool printable = code >= KC_A && code <= KC_SLSH && code != KC_ESC && code != KC_BSPC;
+    char text[32];
+    if (printable && !(mods & (MOD_MASK_CTRL | MOD_MASK_ALT | MOD_MASK_GUI))) {
+        snprintf(text, sizeof(text), "%c", key_chars[shift][code - KC_A]);
+    } else {
+        char base[8];
+        if (code == KC_SPC || code == KC_ENT || code == KC_TAB) {
+            snprintf(base, sizeof(base), "%s", code == KC_SPC ? "space" : code == KC_ENT ? "enter" : "tab");
+        } else if (printable) {
+            snprintf(base, sizeof(base), "%c", key_chars[0][code - KC_A]);
+        } else {
+            snprintf(base, sizeof(base), "%s", key_name(code));
+        }
+        snprintf(text, sizeof(text), "<%s%s%s%s%s>", mods & MOD_MASK_CTRL ? "C-" : "", mods & MOD_MASK_ALT ? "A-" : "", mods & MOD_MASK_GUI ? "G-" : "", shift ? "S-" : "", base);
+    }
+    type_text(text);
+}
+
+static void record_report(const report_keyboard_t *previous) {
+    if (sim_report_count < SIM_MAX_REPORTS) {
+        sim_report_t *logged = &sim_reports[sim_report_count++];
+        logged->time_us      = now_us;
+        logged->mods         = report.mods;
+        memcpy(logged->keys, report.keys, sizeof(report.keys));
+    }
+    // Only a report that adds a key or a modifier answers a press, not one that lets go of the last key.
+    bool added = report.mods & ~previous->mods;
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (!report.keys[i] || memchr(previous->keys, report.keys[i], sizeof(previous->keys))) continue;
+        type_key(report.keys[i], report.mods);
+        added = true;
+    }
+    if (added) latency_report();
+}
+
+void send_keyboard_report(void) {
+    report.mods = real_mods | weak_mods;
+    if (!memcmp(&report, &last_report, sizeof(report))) return;
+    report_keyboard_t previous = last_report;
+    last_report                = report;
+    record_report(&previous);
+}
+
+uint8_t get_mods(void) {
+    return real_mods;
+}
+void add_mods(uint8_t mods) {
+    real_mods |= mods;
+}
+void del_mods(uint8_t mods) {
+    real_mods &= ~mods;
+}
+void set_mods(uint8_t mods) {
+    real_mods = mods;
+}
+void clear_mods(void) {
+    real_mods = 0;
+}
+uint8_t get_weak_mods(void) {
+    return weak_mods;
+}
+void add_weak_mods(uint8_t mods) {
+    weak_mods |= mods;
+}
+void del_weak_mods(uint8_t mods) {
+    weak_mods &= ~mods;
+}
+void set_weak_mods(uint8_t mods) {
+    weak_mods = mods;
+}
+void clear_weak_mods(void) {
+    weak_mods = 0;
+}
+uint8_t get_oneshot_mods(void) {
+    return 0;
+}
+
+void add_key(uint8_t key) {
+    int8_t empty = -1;
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i] == key) return;
+        if (empty < 0 && !report.keys[i]) empty = i;
+    }
+    if (empty >= 0) report.keys[empty] = key;
+}
+
+void del_key(uint8_t key) {
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i] == key) report.keys[i] = 0;
+    }
+}
+
+static bool is_key_pressed(uint8_t key) {
+    return memchr(report.keys, key, sizeof(report.keys));
+}
+
+report_mouse_t mousekey_get_report(void) {
+    return (report_mouse_t){.buttons = mouse_buttons};
+}
+
+void host_mouse_send(report_mouse_t *mouse_report) {
+    sim_mouse_report_count++;
+    sim_mouse_last = *mouse_report;
+    latency_report();
+}
+
+static void register_mouse(uint8_t code, bool pressed) {
+    if (!IS_MOUSEKEY_BUTTON(code)) return;
+    uint8_t bit = 1 << (code - KC_BTN1);
+    if (pressed) {
+        mouse_buttons |= bit;
+    } else {
+        mouse_buttons &= ~bit;
+    }
+    report_mouse_t mouse_report = mousekey_get_report();
+    host_mouse_send(&mouse_report);
+}
+
+void register_code(uint8_t code) {
+    if (code == KC_NO) return;
+    if (IS_BASIC_KEYCODE(code)) {
+        // A key already down goes up first, so the host sees it again.
+        if (is_key_pressed(code)) {
+            del_key(code);
+            send_keyboard_report();
+        }
+        add_key(code);
+        send_keyboard_report();
+    } else if (IS_MODIFIER_KEYCODE(code)) {
+        add_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else if (IS_MOUSE_KEYCODE(code)) {
+        register_mouse(code, true);
+    }
+}
+
+void unregister_code(uint8_t code) {
+    if (code == KC_NO) return;
+    if (IS_BASIC_KEYCODE(code)) {
+        del_key(code);
+        send_keyboard_report();
+    } else if (IS_MODIFIER_KEYCODE(code)) {
+        del_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else if (IS_MOUSE_KEYCODE(code)) {
+        register_mouse(code, false);
+    }
+}
+
+void tap_code(uint8_t code) {
+    register_code(code);
+    unregister_code(code);
+}
+
+void register_mods(uint8_t mods) {
+    if (!mods) return;
+    add_mods(mods);
+    send_keyboard_report();
+}
+
+void unregister_mods(uint8_t mods) {
+    if (!mods) return;
+    del_mods(mods);
+    send_keyboard_report();
+}
+
+void register_weak_mods(uint8_t mods) {
+    if (!mods) return;
+    add_weak_mods(mods);
+    send_keyboard_report();
+}
+
+void unregister_weak_mods(uint8_t mods) {
+    if (!mods) return;
+    del_weak_mods(mods);
+    send_keyboard_report();
+}
+
+void do_code16(uint16_t code, void (*f)(uint8_t)) {
+    if (IS_MODIFIER_KEYCODE(code) || code == KC_NO) return;
+    uint8_t mods  = QK_MODS_GET_MODS(code);
+    uint8_t shift = mods & 0x10 ? 4 : 0;
+    f((mods & 0x0F) << shift);
+}
+
+void register_code16(uint16_t code) {
+    if (IS_MODIFIER_KEYCODE(code) || code == KC_NO) {
+        do_code16(code, register_mods);
+    } else {
+        do_code16(code, register_weak_mods);
+    }
+    register_code(code);
+}
+
+void unregister_code16(uint16_t code) {
+    unregister_code(code);
+    if (IS_MODIFIER_KEYCODE(code) || code == KC_NO) {
+        do_code16(code, unregister_mods);
+    } else {
+        do_code16(code, unregister_weak_mods);
+    }
+}
+
+void tap_code16(uint16_t code) {
+    register_code16(code);
+    unregister_code16(code);
+}
+
+/* Tap dance, process_tap_dance.c */
+
+static uint16_t active_td;
+static uint16_t last_tap_time;
+
+static void td_action_fn(tap_dance_action_t *action, tap_dance_user_fn_t fn) {
+    if (fn) fn(&action->state, action->user_data);
+}
+
+static void td_on_each_tap(tap_dance_action_t *action) {
+    action->state.count++;
+    action->state.weak_mods = get_mods() | get_weak_mods();
+    td_action_fn(action, action->fn.on_each_tap);
+}
+
+static void td_on_reset(tap_dance_action_t *action) {
+    td_action_fn(action, action->fn.on_reset);
+    del_weak_mods(action->state.weak_mods);
+    send_keyboard_report();
+    action->state = (const tap_dance_state_t){0};
+}
+
+static void td_on_dance_finished(tap_dance_action_t *action) {
+    if (!action->state.finished) {
+        action->state.finished = true;
+        add_weak_mods(action->state.weak_mods);
+        send_keyboard_report();
+        td_action_fn(action, action->fn.on_dance_finished);
+    }
+    active_td = 0;
+    // No release is coming to reset it.
+    if (!action->state.pressed) td_on_reset(action);
+}
+
+static bool preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed || !active_td || keycode == active_td) return false;
+    tap_dance_action_t *action         = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(active_td)];
+    action->state.interrupted          = true;
+    action->state.interrupting_keycode = keycode;
+    td_on_dance_finished(action);
+    clear_weak_mods();
+    return true;
+}
+
+static void process_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    if (!IS_QK_TAP_DANCE(keycode) || QK_TAP_DANCE_GET_INDEX(keycode) >= TAP_DANCE_COUNT) return;
+    tap_dance_action_t *action = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(keycode)];
+    action->state.pressed      = record->event.pressed;
+    if (record->event.pressed) {
+        last_tap_time = timer_read();
+        td_on_each_tap(action);
+        active_td = action->state.finished ? 0 : keycode;
+    } else {
+        td_action_fn(action, action->fn.on_each_release);
+        if (action->state.finished) {
+            td_on_reset(action);
+            if (active_td == keycode) active_td = 0;
+        }
+    }
+}
+
+static void tap_dance_task(void) {
+    if (!active_td || timer_elapsed(last_tap_time) <= get_tapping_term(active_td, &(keyrecord_t){})) return;
+    tap_dance_action_t *action = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(active_td)];
+    if (!action->state.interrupted) td_on_dance_finished(action);
+}
+
+/* Actions, action.c */
+
+static void process_action(keyrecord_t *record) {
+    keyevent_t event     = record->event;
+    uint16_t   keycode   = get_event_keycode(event, true);
+    uint8_t    tap_count = record->tap.count;
+
+    if (IS_QK_MOD_TAP(keycode)) {
+        uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+        mods         = (mods & 0x0F) << (mods & 0x10 ? 4 : 0);
+        uint8_t code = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+        if (event.pressed) {
+            if (tap_count > 0) {
+                register_code(code);
+            } else {
+                register_mods(mods);
+            }
+        } else {
+            if (tap_count > 0) {
+                unregister_code(code);
+            } else {
+                unregister_mods(mods);
+            }
+        }
+    } else if (IS_QK_LAYER_TAP(keycode)) {
+        uint8_t code = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+        if (event.pressed) {
+            if (tap_count > 0) {
+                register_code(code);
+            } else {
+                // A layer is no report, the keys pressed on it are timed instead.
+                latency_cancel(event.key);
+                layer_on(QK_LAYER_TAP_GET_LAYER(keycode));
+            }
+        } else {
+            if (tap_count > 0) {
+                unregister_code(code);
+            } else {
+                layer_off(QK_LAYER_TAP_GET_LAYER(keycode));
+            }
+        }
+    } else if (keycode <= QK_MODS_MAX) {
+        uint8_t code = QK_MODS_GET_BASIC_KEYCODE(keycode);
+        uint8_t mods = QK_MODS_GET_MODS(keycode);
+        mods         = (mods & 0x0F) << (mods & 0x10 ? 4 : 0);
+        if (event.pressed) {
+            if (mods) {
+                if (IS_MODIFIER_KEYCODE(code) || code == KC_NO) {
+                    add_mods(mods);
+                } else {
+                    add_weak_mods(mods);
+                }
+                send_keyboard_report();
+            }
+            register_code(code);
+        } else {
+            unregister_code(code);
+            if (mods) {
+                if (IS_MODIFIER_KEYCODE(code) || code == KC_NO) {
+                    del_mods(mods);
+                } else {
+                    del_weak_mods(mods);
+                }
+                send_keyboard_report();
+            }
+        }
+    }
+}
+
+static void process_record(keyrecord_t *record) {
+    if (IS_NOEVENT(record->event)) return;
+
+    // process_record_quantum()
+    uint16_t keycode = get_record_keycode(record, true);
+    latency_processed(record, keycode);
+    if (preprocess_tap_dance(keycode, record)) {
+        // The dance may have changed the layer state.
+        keycode = get_record_keycode(record, true);
+    }
+    if (!process_record_user(keycode, record)) return;
+    process_tap_dance(keycode, record);
+
+    process_action(record);
+    post_process_record_user(get_record_keycode(record, false), record);
+}
+
+/* Tapping, action_tapping.c */
+
+#define WAITING_BUFFER_SIZE 8
+
+static keyrecord_t tapping_key;
+static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE];
+static uint8_t     waiting_buffer_head;
+static uint8_t     waiting_buffer_tail;
+
+#ifdef TAPPING_TERM_PER_KEY
+#    define GET_TAPPING_TERM(keycode, record) get_tapping_term(keycode, record)
+#else
+#    define GET_TAPPING_TERM(keycode, record) TAPPING_TERM
+#endif
+#ifdef QUICK_TAP_TERM_PER_KEY
+#    define GET_QUICK_TAP_TERM(keycode, record) get_quick_tap_term(keycode, record)
+#else
+#    define GET_QUICK_TAP_TERM(keycode, record) QUICK_TAP_TERM
+#endif
+#if defined(PERMISSIVE_HOLD_PER_KEY)
+#    define TAP_GET_PERMISSIVE_HOLD get_permissive_hold(get_record_keycode(&tapping_key, false), &tapping_key)
+#elif defined(PERMISSIVE_HOLD)
+#    define TAP_GET_PERMISSIVE_HOLD true
+#else
+#    define TAP_GET_PERMISSIVE_HOLD false
+#endif
+#if defined(HOLD_ON_OTHER_KEY_PRESS_PER_KEY)
+#    define TAP_GET_HOLD_ON_OTHER_KEY_PRESS get_hold_on_other_key_press(get_record_keycode(&tapping_key, false), &tapping_key)
+#elif defined(HOLD_ON_OTHER_KEY_PRESS)
+#    define TAP_GET_HOLD_ON_OTHER_KEY_PRESS true
+#else
+#    define TAP_GET_HOLD_ON_OTHER_KEY_PRESS false
+#endif
+
+#define IS_TAPPING() IS_EVENT(tapping_key.event)
+#define IS_TAPPING_RECORD(r) (IS_TAPPING() && KEYEQ(tapping_key.event.key, (r)->event.key))
+#define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16((e).time, tapping_key.event.time) < GET_TAPPING_TERM(get_record_keycode(&tapping_key, false), &tapping_key))
+#define WITHIN_QUICK_TAP_TERM(e) (TIMER_DIFF_16((e).time, tapping_key.event.time) < GET_QUICK_TAP_TERM(get_record_keycode(&tapping_key, false), &tapping_key))
+
+static bool is_tap_record(keyrecord_t *record) {
+    if (IS_NOEVENT(record->event)) return false;
+    uint16_t keycode = layer_switch_get_keycode(record->event.key);
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
+}
+
+static bool waiting_buffer_typed(keyevent_t event) {
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+        if (KEYEQ(event.key, waiting_buffer[i].event.key) && event.pressed != waiting_buffer[i].event.pressed) return true;
+    }
+    return false;
+}
+
+static void waiting_buffer_scan_tap(void) {
+    if (tapping_key.tap.count > 0 || !tapping_key.event.pressed) return;
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+        keyrecord_t *candidate = &waiting_buffer[i];
+        if (IS_EVENT(candidate->event) && KEYEQ(candidate->event.key, tapping_key.event.key) && !candidate->event.pressed && WITHIN_TAPPING_TERM(candidate->event)) {
+            tapping_key.tap.count = 1;
+            candidate->tap.count  = 1;
+            process_record(&tapping_key);
+            return;
+        }
+    }
+}
+
+// Whether the release of a key pressed before the tapping key has to wait behind it.
+static bool release_waits(keyrecord_t *keyp) {
+    uint16_t keycode = layer_switch_get_keycode(keyp->event.key);
+    if (IS_QK_MOD_TAP(keycode)) return keyp->tap.count == 0;
+    if (IS_QK_LAYER_TAP(keycode)) return true;
+    if (keycode <= QK_MODS_MAX) {
+        uint8_t code = QK_MODS_GET_BASIC_KEYCODE(keycode);
+        if (QK_MODS_GET_MODS(keycode) && !code) return true;
+        return IS_MODIFIER_KEYCODE(code);
+    }
+    return false;
+}
+
+static bool process_tapping(keyrecord_t *keyp) {
+    keyevent_t event = keyp->event;
+
+    if (!IS_TAPPING()) {
+        if (!IS_EVENT(event)) {
+            // Tick
+        } else if (event.pressed && is_tap_record(keyp)) {
+            tapping_key = *keyp;
+            waiting_buffer_scan_tap();
+        } else {
+            process_record(keyp);
+        }
+        return true;
+    }
+
+    if (tapping_key.event.pressed) {
+        if (WITHIN_TAPPING_TERM(event)) {
+            if (IS_NOEVENT(event)) return true;
+            if (tapping_key.tap.count == 0) {
+                if (IS_TAPPING_RECORD(keyp) && !event.pressed) {
+                    // First tap
+                    tapping_key.tap.count = 1;
+                    process_record(&tapping_key);
+                    keyp->tap = tapping_key.tap;
+                    return false;
+                } else if (!event.pressed && waiting_buffer_typed(event) && TAP_GET_PERMISSIVE_HOLD) {
+                    // Another key pressed and released within the term
+                    process_record(&tapping_key);
+                    tapping_key = (keyrecord_t){0};
+                    return false;
+                } else if (!event.pressed && !waiting_buffer_typed(event)) {
+                    // Release of a key pressed before the tapping key
+                    if (release_waits(keyp)) return false;
+                    process_record(keyp);
+                    return true;
+                } else {
+                    if (event.pressed) {
+                        tapping_key.tap.interrupted = true;
+                        if (TAP_GET_HOLD_ON_OTHER_KEY_PRESS) {
+                            process_record(&tapping_key);
+                            tapping_key = (keyrecord_t){0};
+                        }
+                    }
+                    return false;
+                }
+            } else {
+                if (IS_TAPPING_RECORD(keyp) && !event.pressed) {
+                    keyp->tap = tapping_key.tap;
+                    process_record(keyp);
+                    tapping_key = *keyp;
+                    return true;
+                } else if (is_tap_record(keyp) && event.pressed) {
+                    if (tapping_key.tap.count > 1) {
+                        process_record(&(keyrecord_t){.tap = tapping_key.tap, .event.key = tapping_key.event.key, .event.time = event.time, .event.pressed = false, .event.type = tapping_key.event.type});
+                    }
+                    tapping_key = *keyp;
+                    waiting_buffer_scan_tap();
+                    return true;
+                } else {
+                    process_record(keyp);
+                    return true;
+                }
+            }
+        } else {
+            if (tapping_key.tap.count == 0) {
+                // Held past the term
+                process_record(&tapping_key);
+                tapping_key = (keyrecord_t){0};
+                return false;
+            } else {
+                if (IS_NOEVENT(event)) return true;
+                if (IS_TAPPING_RECORD(keyp) && !event.pressed) {
+                    keyp->tap = tapping_key.tap;
+                    process_record(keyp);
+                    tapping_key = (keyrecord_t){0};
+                    return true;
+                } else if (is_tap_record(keyp) && event.pressed) {
+                    if (tapping_key.tap.count > 1) {
+                        process_record(&(keyrecord_t){.tap = tapping_key.tap, .event.key = tapping_key.event.key, .event.time = event.time, .event.pressed = false, .event.type = tapping_key.event.type});
+                    }
+                    tapping_key = *keyp;
+                    waiting_buffer_scan_tap();
+                    return true;
+                } else {
+                    process_record(keyp);
+                    return true;
+                }
+            }
+        }
+    } else {
+        if (WITHIN_TAPPING_TERM(event)) {
+            if (IS_NOEVENT(event)) return true;
+            if (event.pressed) {
+                if (IS_TAPPING_RECORD(keyp)) {
+                    if (WITHIN_QUICK_TAP_TERM(event) && !tapping_key.tap.interrupted && tapping_key.tap.count > 0) {
+                        // Sequential tap
+                        keyp->tap = tapping_key.tap;
+                        if (keyp->tap.count < 15) keyp->tap.count += 1;
+                        process_record(keyp);
+                        tapping_key = *keyp;
+                        return true;
+                    }
+                    tapping_key = *keyp;
+                    return true;
+                } else if (is_tap_record(keyp)) {
+                    tapping_key = *keyp;
+                    waiting_buffer_scan_tap();
+                    return true;
+                } else {
+                    tapping_key.tap.interrupted = true;
+                    process_record(keyp);
+                    return true;
+                }
+            } else {
+                process_record(keyp);
+                return true;
+            }
+        } else {
+            tapping_key = (keyrecord_t){0};
+            return false;
+        }
+    }
+}
+
+static void action_tapping_process(keyrecord_t record) {
+    if (!process_tapping(&record) && IS_EVENT(record.event)) {
+        uint8_t next = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
+        if (next == waiting_buffer_tail) {
+            fprintf(stderr, "waiting buffer overflow\n");
+            abort();
+        }
+        waiting_buffer[waiting_buffer_head] = record;
+        waiting_buffer_head                 = next;
+    }
+    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
+        if (!process_tapping(&waiting_buffer[waiting_buffer_tail])) break;
+    }
+}
+
+/* Main loop, action.c and keyboard.c */
+
+void action_exec(keyevent_t event) {
+    // The weak mods of the last key do not carry over to this one.
+    if (event.pressed) clear_weak_mods();
+
+    keyrecord_t record = {.event = event};
+    // pre_process_record_quantum()
+    if (IS_NOEVENT(record.event) || pre_process_record_user(get_record_keycode(&record, true), &record)) {
+        action_tapping_process(record);
+    }
+}
+
+static void sim_pass(keyevent_t event) {
+    static uint16_t last_tick;
+
+    matrix_scan_user();
+    if (IS_EVENT(event)) {
+        input_activity_us = now_us;
+        action_exec(event);
+    } else if (timer_read() != last_tick) {
+        action_exec(MAKE_TICK_EVENT);
+        last_tick = timer_read();
+    }
+    tap_dance_task();
+    housekeeping_task_user();
+    now_us += sim_scan_us;
+}
+
+static void sim_key_change(uint8_t position, bool pressed) {
+    keypos_t     key = sim_key(position);
+    matrix_row_t bit = (matrix_row_t)1 << key.col;
+    if (pressed) {
+        matrix[key.row] |= bit;
+        presses[position] = (typeof(presses[0])){.pending = true, .class = latency_class(sim_keycode(position)), .pressed_us = now_us};
+    } else {
+        matrix[key.row] &= ~bit;
+    }
+    sim_pass(MAKE_KEYEVENT(key.row, key.col, pressed));
+    // Processed and let go without a report: the key sends nothing, or not yet in the case of a dance.
+    if (!pressed && presses[position].processed && presses[position].class < SIM_DANCE) presses[position].pending = false;
+}
+
+void sim_down(uint8_t position) {
+    sim_key_change(position, true);
+}
+
+void sim_up(uint8_t position) {
+    sim_key_change(position, false);
+}
+
+void sim_tap(uint8_t position) {
+    sim_down(position);
+    sim_wait(SIM_TAP_MS);
+    sim_up(position);
+}
+
+void sim_wait_us(uint64_t us) {
+    uint64_t until = now_us + us;
+    while (now_us < until) {
+        sim_pass(MAKE_TICK_EVENT);
+    }
+}
+
+void sim_wait(uint32_t ms) {
+    sim_wait_us(ms * 1000ULL);
+}
+
+/* Reading back */
+
+const char *sim_typed(void) {
+    return typed;
+}
+
+uint8_t sim_mods(void) {
+    return last_report.mods;
+}
+
+bool sim_report_empty(void) {
+    static const uint8_t none[KEYBOARD_REPORT_KEYS];
+    return !last_report.mods && !memcmp(last_report.keys, none, sizeof(none));
+}
+
+void sim_clear(void) {
+    typed_length           = 0;
+    typed[0]               = '\0';
+    sim_report_count       = 0;
+    sim_mouse_report_count = 0;
+}
+
+/* EEPROM, raw HID and console */
+
+uint8_t sim_eeprom[1024];
+uint8_t sim_raw_hid[32];
+uint8_t sim_raw_hid_length;
+bool    sim_console_echo;
+
+static char   console[1 << 16];
+static size_t console_length;
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    memcpy(buf, sim_eeprom + (uintptr_t)addr, len);
+}
+
+void eeprom_update_block(const void *buf, void *addr, size_t len) {
+    memcpy(sim_eeprom + (uintptr_t)addr, buf, len);
+}
+
+void raw_hid_send(uint8_t *data, uint8_t length) {
+    sim_raw_hid_length = MIN(length, sizeof(sim_raw_hid));
+    memcpy(sim_raw_hid, data, sim_raw_hid_length);
+}
+
+void uprintf(const char *fmt, ...) {
+    va_list args;
+    if (sim_console_echo) {
+        // Echoed in full, the buffer only keeps what fits
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+    }
+    va_start(args, fmt);
+    int length = vsnprintf(console + console_length, sizeof(console) - console_length, fmt, args);
+    va_end(args);
+    if (length < 0) return;
+    console_length = MIN(console_length + length, sizeof(console) - 1);
+}
+
+const char *sim_console(void) {
+    return console;
+}
+
+/* Cases */
+
+int        sim_failures;
+static int cases;
+static int failed_cases;
+
+void sim_boot(void) {
+    memset(sim_eeprom, 0xFF, sizeof(sim_eeprom));
+    default_layer_state = default_layer_state_set_user(1);
+    keyboard_post_init_user();
+}
+
+void sim_check(bool ok, const char *file, int line, const char *what) {
+    if (ok) return;
+    fprintf(stderr, "%s:%d: %s\n", file, line, what);
+    sim_failures++;
+}
+
+static void print_escaped(const char *text) {
+    for (; *text; text++) {
+        if (*text == '\n') {
+            fputs("\\n", stderr);
+        } else if (*text == '\t') {
+            fputs("\\t", stderr);
+        } else if (*text == '\b') {
+            fputs("\\b", stderr);
+        } else if (*text == '\x1b') {
+            fputs("\\e", stderr);
+        } else {
+            fputc(*text, stderr);
+        }
+    }
+}
+
+void sim_check_typed(const char *expected, const char *file, int line) {
+    if (!strcmp(expected, typed)) return;
+    fprintf(stderr, "%s:%d: typed \"", file, line);
+    print_escaped(typed);
+    fputs("\", expected \"", stderr);
+    print_escaped(expected);
+    fputs("\"\n", stderr);
+    sim_failures++;
+}
+
+void sim_case(const char *name, void (*run)(void)) {
+    fflush(stdout);
+    fflush(stderr);
+    cases++;
+    pid_t pid = fork();
+    if (pid == 0) {
+        sim_boot();
+        run();
+        fflush(stdout);
+        _exit(sim_failures ? 1 : 0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (!ok) failed_cases++;
+    printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+}
+
+int sim_summary(void) {
+    if (failed_cases) printf("%d of %d cases failed\n", failed_cases, cases);
+    return failed_cases ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+#ifndef FERRIS_SWEEP_SIM_H
+#define FERRIS_SWEEP_SIM_H
+
+/* Host harness: the keymap sources built for Linux against the QMK stand-ins in
+ * qmk/, with sim.c playing QMK's core on a virtual clock.
+ *
+ * sim.c follows QMK 0.2x where the keymap can tell the difference:
+ *  - action_exec() runs pre_process_record_user() before the tapping code sees the
+ *    event, and process_record() interrupts a pending tap dance (preprocess_tap_dance)
+ *    after that, right before process_record_user().
+ *  - The tapping code buffers events behind an undecided mod-tap or layer-tap, with
+ *    PERMISSIVE_HOLD and the per-key tapping terms, quick tap terms and
+ *    get_hold_on_other_key_press().
+ *  - Layers are looked up through keycode_at_keymap_location(), a release uses the
+ *    layer its press was looked up on.
+ *  - One pass of the main loop is an event or a tick (at most one per ms), then
+ *    tap_dance_task() and housekeeping_task_user(). A pass takes sim_scan_us.
+ *
+ * Every keyboard report that differs from the last one is kept with its time. Tests
+ * read them back as text (sim_typed()) or as reports. Each press is timed to the first
+ * report after it that adds a key or modifier, per key class, for sim_latency_print().
+ *
+ * Keys are named by their layout position, POS_L11 to POS_R42 from sparse_layers.h.
+ * sim_case() runs each case in a child process, so every case starts from a freshly
+ * booted keyboard.
+ */
+
+#include QMK_KEYBOARD_H
+
+#include "sparse_layers.h"
+
+#define SIM_MAX_REPORTS 4096
+
+typedef struct {
+    uint64_t time_us;
+    uint8_t  mods;
+    uint8_t  keys[KEYBOARD_REPORT_KEYS];
+} sim_report_t;
+
+extern sim_report_t sim_reports[SIM_MAX_REPORTS];
+extern uint16_t     sim_report_count;
+extern uint16_t     sim_mouse_report_count;
+extern report_mouse_t sim_mouse_last;
+
+// Length of one pass of the main loop, 500 µs unless a test changes it
+extern uint32_t sim_scan_us;
+// Print the console output as it is written, instead of only keeping it
+extern bool sim_console_echo;
+// Last raw HID packet the keymap sent
+extern uint8_t sim_raw_hid[32];
+extern uint8_t sim_raw_hid_length;
+// The emulated EEPROM, erased to 0xFF
+extern uint8_t sim_eeprom[1024];
+
+// Erase the EEPROM and run the keymap's init hooks, sim_case() does it for each case.
+void sim_boot(void);
+// Set a key's matrix bit and run the pass that picks it up.
+void sim_down(uint8_t position);
+void sim_up(uint8_t position);
+// Press, hold for SIM_TAP_MS and release.
+void sim_tap(uint8_t position);
+#define SIM_TAP_MS 40
+// Run the main loop for a while.
+void sim_wait(uint32_t ms);
+void sim_wait_us(uint64_t us);
+uint64_t sim_now_us(void);
+
+// Matrix position of a layout position.
+keypos_t sim_key(uint8_t position);
+// Keycode QMK would look up for a press of the key right now.
+uint16_t sim_keycode(uint8_t position);
+
+/* What the host saw since the last sim_clear(): each key that went down, in order,
+ * as the character it types with the Shift in the report. Keys that type no character
+ * read as <name>, and Ctrl, Alt and GUI as a C-, A- or G- prefix, e.g. "<C-c>".
+ */
+const char *sim_typed(void);
+uint8_t     sim_mods(void);
+bool        sim_report_empty(void);
+void        sim_clear(void);
+// Everything the keymap printed with uprintf().
+const char *sim_console(void);
+
+// Press-to-first-report latency per key class, over the presses since boot.
+void sim_latency_print(void);
+
+/* Test cases */
+
+extern int sim_failures;
+
+#define CHECK(condition) sim_check((condition), __FILE__, __LINE__, #condition)
+#define CHECK_TYPED(expected) sim_check_typed((expected), __FILE__, __LINE__)
+
+void sim_check(bool ok, const char *file, int line, const char *what);
+void sim_check_typed(const char *expected, const char *file, int line);
+// Run a case in a child process on a freshly booted keyboard.
+void sim_case(const char *name, void (*run)(void));
+// Exit status for main(): 0 when every case passed.
+int sim_summary(void);
+
+#endif
@@ -0,0 +1,73 @@
+/* debounce.c against the traces in bounce_traces.h, on an eager finger key and a deferred thumb. */
+#include <stdio.h>
+
+#include "sim.h"
+#include "debounce.h"
+#include "bounce_traces.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#define SCAN_US 250
+// A trace is followed by this much quiet, enough for any release to settle
+#define SETTLE_US ((DEBOUNCE + 10) * 1000)
+
+// Raw contact state of a trace at a time.
+static bool contact(const bounce_trace_t *trace, uint32_t us) {
+    bool closed = false;
+    for (uint8_t i = 0; i < trace->edge_count && trace->edges[i] <= us; i++) closed = !closed;
+    return closed;
+}
+
+static void check_trace(const bounce_trace_t *trace, uint8_t position, uint8_t expected, bool eager) {
+    keypos_t     key = sim_key(position);
+    matrix_row_t raw[MATRIX_ROWS] = {0}, cooked[MATRIX_ROWS] = {0};
+    uint32_t     first = trace->edges[0], last = trace->edges[trace->edge_count - 1];
+    uint32_t     first_press_us = 0, last_release_us = 0;
+    uint8_t      presses = 0, releases = 0;
+
+    sim_scan_us = SCAN_US;
+    debounce_init(MATRIX_ROWS);
+    for (uint32_t us = 0; us < last + SETTLE_US; us += SCAN_US) {
+        raw[key.row] = contact(trace, us) ? (matrix_row_t)1 << key.col : 0;
+        bool was     = cooked[key.row] >> key.col & 1;
+        debounce(raw, cooked, MATRIX_ROWS, true);
+        bool is = cooked[key.row] >> key.col & 1;
+        if (is && !was && !presses++) first_press_us = us;
+        if (!is && was) {
+            releases++;
+            last_release_us = us;
+        }
+        sim_wait_us(SCAN_US);
+    }
+
+    char what[160];
+    snprintf(what, sizeof(what), "%s, %s: %u presses and %u releases, expected %u", trace->name, eager ? "eager" : "deferred", presses, releases, expected);
+    sim_check(presses == expected && releases == expected, __FILE__, __LINE__, what);
+    if (!presses) return;
+    // An eager press is reported by the scan that first sees the contact.
+    snprintf(what, sizeof(what), "%s, eager: pressed %u us after the first edge", trace->name, first_press_us - first);
+    if (eager) sim_check(first_press_us - first < SCAN_US, __FILE__, __LINE__, what);
+    /* Every release settles DEBOUNCE ms after the last edge, give or take a scan and the ms
+     * timer. An eager press is locked for DEBOUNCE ms first, so a spike shorter than that
+     * settles from the end of the lock.
+     */
+    uint32_t settled = eager && first + DEBOUNCE * 1000 > last ? first + DEBOUNCE * 1000 : last;
+    snprintf(what, sizeof(what), "%s, %s: released %u us after the last edge", trace->name, eager ? "eager" : "deferred", last_release_us - last);
+    sim_check(last_release_us >= last && last_release_us - settled <= (DEBOUNCE + 1) * 1000 + SCAN_US, __FILE__, __LINE__, what);
+}
+
+static void eager_traces(void) {
+    for (uint8_t i = 0; i < BOUNCE_TRACE_COUNT; i++) check_trace(&bounce_traces[i], POS_L24, bounce_traces[i].eager_presses, true);
+}
+
+static void deferred_traces(void) {
+    for (uint8_t i = 0; i < BOUNCE_TRACE_COUNT; i++) check_trace(&bounce_traces[i], POS_L42, bounce_traces[i].deferred_presses, false);
+}
+
+int main(void) {
+    sim_case("an eager key reports each trace once", eager_traces);
+    sim_case("a deferred key reports each trace once", deferred_traces);
+    return sim_summary();
+}
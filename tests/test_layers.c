@@ -0,0 +1,55 @@
+/* Layers: what each thumb turns on, and the layer they make together. */
+#include "sim.h"
+#include "layers.h"
+
+// Hold one thumb, then the other, then click with POINTER's left button.
+static void thumbs_reach_pointer(uint8_t first, uint8_t second) {
+    sim_down(first);
+    sim_wait(100);
+    sim_down(second);
+    sim_wait(100);
+    sim_down(POS_L24);
+    sim_wait(20);
+    CHECK(layer_state_is(POINTER));
+    CHECK(sim_mouse_last.buttons & MOUSE_BTN1);
+    sim_up(POS_L24);
+    sim_wait(20);
+    CHECK(!(sim_mouse_last.buttons & MOUSE_BTN1));
+    sim_up(second);
+    sim_up(first);
+    sim_wait(20);
+    CHECK(!layer_state_is(POINTER));
+    CHECK_TYPED("");
+    CHECK(sim_report_empty());
+}
+
+static void navigation_then_media(void) {
+    thumbs_reach_pointer(POS_L42, POS_L41);
+}
+
+static void media_then_navigation(void) {
+    thumbs_reach_pointer(POS_L41, POS_L42);
+}
+
+// POINTER moves the cursor while a direction is held.
+static void pointer_moves(void) {
+    sim_down(POS_L42);
+    sim_wait(100);
+    sim_down(POS_L41);
+    sim_wait(100);
+    sim_down(POS_R23);
+    sim_wait(100);
+    CHECK(sim_mouse_report_count > 0);
+    CHECK(sim_mouse_last.y < 0);
+    sim_up(POS_R23);
+    sim_up(POS_L41);
+    sim_up(POS_L42);
+    CHECK(sim_report_empty());
+}
+
+int main(void) {
+    sim_case("NAVIGATION then MEDIA is POINTER", navigation_then_media);
+    sim_case("MEDIA then NAVIGATION is POINTER", media_then_navigation);
+    sim_case("POINTER moves the cursor", pointer_moves);
+    return sim_summary();
+}
@@ -0,0 +1,214 @@
+/* Tap dances: the tiers they resolve to, and how early. */
+#include "sim.h"
+#include "layers.h"
+#include "tap_hold.h"
+#ifdef LATENCY_HISTOGRAM_ENABLE
+#    include "latency.h"
+#endif
+
+// Symbol layer from the Backspace thumb, taken as soon as the next key goes down.
+static void symbol_layer_down(void) {
+    sim_down(POS_R41);
+    sim_wait(100);
+}
+
+static void released_alone_taps(void) {
+    symbol_layer_down();
+    sim_tap(POS_L23);
+    sim_wait(250);
+    CHECK_TYPED("[");
+    sim_up(POS_R41);
+    CHECK(sim_report_empty());
+}
+
+static void held_past_the_term_holds(void) {
+    symbol_layer_down();
+    sim_down(POS_L23);
+    sim_wait(250);
+    CHECK(sim_mods() == MOD_BIT(KC_LCTL));
+    sim_tap(POS_R11);
+    sim_up(POS_L23);
+    sim_up(POS_R41);
+    CHECK_TYPED("<C-6>");
+    CHECK(sim_report_empty());
+}
+
+// TAP_DANCE_PERMISSIVE_HOLD: a thumb tapped inside the dance, well within the term.
+static void nested_tap_holds(void) {
+    symbol_layer_down();
+    sim_down(POS_L23);
+    sim_wait(30);
+    sim_down(POS_L42);
+    sim_wait(30);
+    sim_up(POS_L42);
+    CHECK(sim_mods() == MOD_BIT(KC_LCTL));
+    sim_wait(20);
+    sim_up(POS_L23);
+    sim_up(POS_R41);
+    CHECK_TYPED("<C-space>");
+    CHECK(sim_report_empty());
+}
+
+// A held back press goes through pre_process_record_user() once, so tap_hold.c is not left waiting on it.
+static void nested_tap_is_counted_once(void) {
+    symbol_layer_down();
+    sim_down(POS_L23);
+    sim_wait(30);
+    sim_up(POS_R41); // The Space thumb below is looked up on the base layer now, as a layer-tap
+    sim_down(POS_L42);
+    sim_wait(30);
+    sim_up(POS_L42);
+    sim_up(POS_L23);
+    CHECK_TYPED("<C-space>");
+    sim_clear();
+    // With nothing left undecided, a same hand roll between mod-taps taps the first one early.
+    sim_down(POS_L24);
+    sim_wait(30);
+    sim_down(POS_L23);
+    CHECK(tap_hold_stats.same_hand_taps == 1);
+    sim_wait(30);
+    sim_up(POS_L24);
+    sim_up(POS_L23);
+    CHECK_TYPED("fd");
+    CHECK(sim_report_empty());
+}
+
+// OPPOSITE_HAND_HOLD: a key on the other half settles the hold on its press.
+static void opposite_hand_press_holds(void) {
+    symbol_layer_down();
+    sim_down(POS_L23);
+    sim_wait(30);
+    sim_down(POS_R11);
+    CHECK_TYPED("<C-6>");
+    sim_up(POS_R11);
+    sim_up(POS_L23);
+    sim_up(POS_R41);
+    CHECK(sim_report_empty());
+}
+
+// The dance key goes down while the thumb under it is still undecided, on the right half this time.
+static void opposite_hand_press_holds_on_the_right(void) {
+    symbol_layer_down();
+    sim_down(POS_R23);
+    sim_wait(30);
+    sim_down(POS_L13);
+    CHECK_TYPED("<C-3>");
+    sim_up(POS_L13);
+    sim_up(POS_R23);
+    sim_up(POS_R41);
+    CHECK(sim_report_empty());
+}
+
+// A roll into the next key on the same half is two taps.
+static void same_hand_roll_taps(void) {
+    symbol_layer_down();
+    sim_down(POS_L23);
+    sim_wait(30);
+    sim_down(POS_L24);
+    sim_wait(30);
+    sim_up(POS_L23);
+    sim_wait(30);
+    sim_up(POS_L24);
+    sim_wait(250);
+    sim_up(POS_R41);
+    CHECK_TYPED("[(");
+    CHECK(sim_report_empty());
+}
+
+// With SYMBOL_MOD_TAPS a double tap is the symbol twice, the partner takes Shift.
+static void double_tap_types_the_partner(void) {
+    symbol_layer_down();
+    sim_tap(POS_L23);
+    sim_wait(30);
+    sim_tap(POS_L23);
+    sim_wait(250);
+    sim_up(POS_R41);
+#ifdef SYMBOL_MOD_TAPS
+    CHECK_TYPED("[[");
+#else
+    CHECK_TYPED("]");
+#endif
+    CHECK(sim_report_empty());
+}
+
+// Taps on one half, each one over before the next, leave no modifier behind.
+static void taps_on_one_half_hold_nothing(void) {
+    symbol_layer_down();
+    sim_tap(POS_L23);
+    sim_wait(30);
+    sim_tap(POS_L22);
+    sim_wait(30);
+    sim_tap(POS_L23);
+    sim_wait(250);
+    sim_up(POS_R41);
+    CHECK_TYPED("[&[");
+    CHECK(sim_mods() == 0);
+    CHECK(sim_report_empty());
+}
+
+// TD_SPECULATE: the guessed single tap goes out on the press, a Backspace takes it back for the double tap.
+static void wrong_guess_is_taken_back(void) {
+    sim_tap(POS_L11);
+    CHECK_TYPED("q");
+    sim_wait(30);
+    sim_tap(POS_L11);
+    sim_wait(250);
+    CHECK_TYPED("q<bs><esc>");
+    CHECK(sim_report_empty());
+}
+
+// With Ctrl held the guess would be Ctrl+Q, so the dance waits and sends only what it resolves to.
+static void no_guess_with_a_modifier(void) {
+    sim_down(POS_R23);
+    sim_wait(250);
+    CHECK(sim_mods() == MOD_BIT(KC_RCTL));
+    sim_tap(POS_L11);
+    CHECK_TYPED("");
+    sim_wait(30);
+    sim_tap(POS_L11);
+    sim_wait(250);
+    sim_up(POS_R23);
+    CHECK_TYPED("<C-esc>");
+    CHECK(sim_report_empty());
+}
+
+#ifdef LATENCY_HISTOGRAM_ENABLE
+// TD_SPECULATE: the right guess went out on the press, and is the dance's one latency sample.
+static void right_guess_is_one_sample(void) {
+    sim_tap(POS_L11);
+    sim_wait(250);
+    CHECK_TYPED("q");
+    latency_print();
+    CHECK(strstr(sim_console(), "lat single-tap: 1 presses, avg 0 "));
+}
+
+// A wrong guess is taken back, and only the tier the dance resolved to is counted.
+static void wrong_guess_is_one_sample(void) {
+    sim_tap(POS_L11);
+    sim_wait(30);
+    sim_tap(POS_L11);
+    sim_wait(250);
+    latency_print();
+    CHECK(strstr(sim_console(), "lat double-tap: 1 presses"));
+    CHECK(!strstr(sim_console(), "lat single-tap"));
+}
+#endif
+
+int main(void) {
+    sim_case("released alone, a dance taps", released_alone_taps);
+    sim_case("held past the term, a dance holds", held_past_the_term_holds);
+    sim_case("a nested tap makes a dance hold", nested_tap_holds);
+    sim_case("a nested tap is counted once", nested_tap_is_counted_once);
+    sim_case("a press on the other half makes a dance hold", opposite_hand_press_holds);
+    sim_case("a press on the other half makes a right hand dance hold", opposite_hand_press_holds_on_the_right);
+    sim_case("a same hand roll taps a dance", same_hand_roll_taps);
+    sim_case("a double tap types the partner", double_tap_types_the_partner);
+    sim_case("taps on one half hold nothing", taps_on_one_half_hold_nothing);
+    sim_case("a wrong guess is taken back with a Backspace", wrong_guess_is_taken_back);
+    sim_case("no guess with a modifier held", no_guess_with_a_modifier);
+#ifdef LATENCY_HISTOGRAM_ENABLE
+    sim_case("a right guess is one latency sample", right_guess_is_one_sample);
+    sim_case("a wrong guess is one latency sample", wrong_guess_is_one_sample);
+#endif
+    return sim_summary();
+}
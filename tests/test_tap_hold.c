@@ -0,0 +1,160 @@
+/* Hold policies: which presses settle a home row mod or a thumb layer-tap, and when. */
+#include "sim.h"
+#include "layers.h"
+#include "tap_hold.h"
+
+/* OPPOSITE_HAND_HOLD: rolling into a key on the same half taps the mod-tap on that press.
+ * The tap starts a typing streak, so the second mod-tap is typed straight away as well.
+ */
+static void same_hand_roll_taps_early(void) {
+    sim_down(POS_L24);
+    sim_wait(30);
+    sim_down(POS_L23);
+    CHECK_TYPED("fd");
+    CHECK(tap_hold_stats.same_hand_taps == 1);
+    sim_wait(30);
+    sim_up(POS_L24);
+    sim_wait(30);
+    sim_up(POS_L23);
+    CHECK_TYPED("fd");
+    CHECK(sim_report_empty());
+}
+
+// The physical release of an early tapped mod-tap is swallowed, the next press of it types again.
+static void early_tap_releases_once(void) {
+    sim_down(POS_L24);
+    sim_wait(30);
+    sim_down(POS_L23);
+    sim_wait(30);
+    sim_up(POS_L23);
+    sim_up(POS_L24);
+    sim_wait(300);
+    sim_tap(POS_L24);
+    sim_wait(250);
+    CHECK_TYPED("fdf");
+    CHECK(tap_hold_stats.same_hand_taps == 1);
+    CHECK(sim_report_empty());
+}
+
+static void opposite_hand_press_holds(void) {
+    sim_down(POS_L24);
+    sim_wait(30);
+    sim_down(POS_R11);
+    CHECK_TYPED("Y");
+    CHECK(tap_hold_stats.opposite_hand_holds == 1);
+    sim_up(POS_R11);
+    sim_up(POS_L24);
+    CHECK(sim_report_empty());
+}
+
+static void held_past_the_term_holds(void) {
+    sim_down(POS_L24);
+    sim_wait(250);
+    CHECK(sim_mods() == MOD_BIT(KC_LSFT));
+    sim_up(POS_L24);
+    CHECK_TYPED("");
+    CHECK(sim_report_empty());
+}
+
+// TAP_HOLD_EAGER: from rest, a thumb's layer is there for the very next key, well within the term.
+static void thumb_from_rest_takes_its_layer(void) {
+    sim_down(POS_R41);
+    sim_wait(20);
+    sim_down(POS_L13);
+    CHECK(layer_state_is(SYMBOL));
+    CHECK_TYPED("3");
+    CHECK(tap_hold_stats.eager_holds == 1);
+    sim_up(POS_L13);
+    sim_up(POS_R41);
+    CHECK(sim_report_empty());
+}
+
+// Mid-word, the Space thumb rolled into the next letter is a space.
+static void space_rolled_mid_word_is_a_space(void) {
+    sim_tap(POS_L13);
+    sim_wait(40);
+    sim_down(POS_L42);
+    sim_wait(30);
+    sim_down(POS_R13);
+    CHECK(!layer_state_is(NAVIGATION));
+    sim_wait(20);
+    sim_up(POS_L42);
+    sim_wait(20);
+    sim_up(POS_R13);
+    CHECK_TYPED("e i");
+    CHECK(tap_hold_stats.eager_holds == 0);
+    CHECK(sim_report_empty());
+}
+
+// After a comma the Space is rolled the same way, the comma keeps the word going.
+static void space_rolled_after_a_comma_is_a_space(void) {
+    sim_tap(POS_R13);
+    sim_wait(40);
+    sim_tap(POS_R33);
+    sim_wait(40);
+    sim_down(POS_L42);
+    sim_wait(30);
+    sim_down(POS_L12);
+    CHECK(!layer_state_is(NAVIGATION));
+    sim_wait(20);
+    sim_up(POS_L42);
+    sim_wait(20);
+    sim_up(POS_L12);
+    CHECK_TYPED("i, w");
+    CHECK(tap_hold_stats.eager_holds == 0);
+    CHECK(sim_report_empty());
+}
+
+/* The same into a home row mod, whose press comes after the streak ran out. Only the
+ * thumb's press time says whether the Space was part of the word.
+ */
+static void space_rolled_into_a_mod_tap_is_a_space(void) {
+    sim_tap(POS_L13);
+    sim_wait(40);
+    sim_down(POS_L42);
+    sim_wait(110);
+    sim_down(POS_R22);
+    CHECK(!layer_state_is(NAVIGATION));
+    sim_wait(20);
+    sim_up(POS_L42);
+    sim_wait(20);
+    sim_up(POS_R22);
+    sim_wait(250);
+    CHECK_TYPED("e j");
+    CHECK(tap_hold_stats.eager_holds == 0);
+    CHECK(sim_report_empty());
+}
+
+// After a Space, a home row mod starting the next word is a letter, even rolled into the other half.
+static void mod_tap_after_a_space_is_a_letter(void) {
+    sim_tap(POS_L13);
+    sim_wait(40);
+    sim_down(POS_L42);
+    sim_wait(65);
+    sim_down(POS_L24);
+    sim_wait(30);
+    sim_up(POS_L42);
+    sim_wait(35);
+    sim_down(POS_R14);
+    CHECK(!sim_mods());
+    sim_wait(30);
+    sim_up(POS_L24);
+    sim_wait(65);
+    sim_up(POS_R14);
+    CHECK_TYPED("e fo");
+    CHECK(tap_hold_stats.opposite_hand_holds == 0);
+    CHECK(sim_report_empty());
+}
+
+int main(void) {
+    sim_case("a same hand roll taps a mod-tap early", same_hand_roll_taps_early);
+    sim_case("an early tapped mod-tap releases once", early_tap_releases_once);
+    sim_case("a press on the other half makes a mod-tap hold", opposite_hand_press_holds);
+    sim_case("held past the term, a mod-tap holds", held_past_the_term_holds);
+    sim_case("a thumb from rest takes its layer on the next press", thumb_from_rest_takes_its_layer);
+    sim_case("a Space rolled mid-word is a space", space_rolled_mid_word_is_a_space);
+    sim_case("a Space rolled after a comma is a space", space_rolled_after_a_comma_is_a_space);
+    sim_case("a Space rolled into a mod-tap is a space", space_rolled_into_a_mod_tap_is_a_space);
+    sim_case("a mod-tap after a Space is a letter", mod_tap_after_a_space_is_a_letter);
+    return sim_summary();
+}
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Decode an event log dump into a per-keystroke timeline.
+
+Capture the console while pressing the STATS key (`qmk console > dump.txt` or
+hid_listen), then run:
+
+    tools/event_log.py dump.txt
+
+Every key press is listed with the delay until the first keyboard report that
+followed it. Tap dances show the tier they resolved to and how long that took.
+Dance, tier and layer names are read from the keymap sources next to this
+directory.
+
+A session recorded with the LOG_LIVE key can be turned into a session file for
+the host replay in tests/, and the output of a replay compared with a golden one:
+
+    tools/event_log.py --session capture.txt > tests/sessions/name.txt
+    tools/event_log.py --golden golden.txt run.txt
+
+`make -C tests check` replays every session in tests/sessions/ and compares it
+with tests/golden/, `make -C tests golden` writes the golden captures anew.
+
+The comparison lists the reports and dance tiers that changed, then how the
+latencies moved. It exits with 1 when the output differs or a report was left
+stuck after every key went up.
+"""
+
+import argparse
+import difflib
+import re
+import sys
+from pathlib import Path
+
+KEYMAP_DIR = Path(__file__).resolve().parent.parent
+
+KEY_DOWN, KEY_UP, DANCE, REPORT, STUCK = range(5)
+
+MOD_NAMES = ["LCTL", "LSFT", "LALT", "LGUI", "RCTL", "RSFT", "RALT", "RGUI"]
+
+
+def read_names(path, pattern):
+    """Return the names matched by pattern in path, in order, or [] when it is missing."""
+    try:
+        return re.findall(pattern, (KEYMAP_DIR / path).read_text())
+    except OSError:
+        return []
+
+
+def enum_body(path, name):
+    """Return the enumerators of enum name in path, without the comments between them."""
+    try:
+        text = (KEYMAP_DIR / path).read_text()
+    except OSError:
+        return ""
+    match = re.search(r"enum\s*\{([^}]*)\}\s*" + name, text) or re.search(r"enum\s+" + name + r"\s*\{([^}]*)\}", text)
+    return re.sub(r"//[^\n]*|/\*.*?\*/", "", match.group(1), flags=re.S) if match else ""
+
+
+def name(names, index):
+    return names[index] if index < len(names) else str(index)
+
+
+def usage_name(usage):
+    if 0x04 <= usage <= 0x1D:
+        return chr(ord("a") + usage - 0x04)
+    if 0x1E <= usage <= 0x27:
+        return str((usage - 0x1D) % 10)
+    return f"0x{usage:02X}"
+
+
+def report_text(mods, key, keys):
+    held = [MOD_NAMES[bit] for bit in range(8) if mods & (1 << bit)]
+    if keys:
+        held.append(usage_name(key) + (f" +{keys - 1}" if keys > 1 else ""))
+    return " ".join(held) if held else "(empty)"
+
+
+def parse(lines):
+    for line in lines:
+        match = re.search(r"\bev (\d+) (\d+) (\d+) (\d+) (\d+)", line)
+        if match:
+            yield tuple(int(field) for field in match.groups())
+
+
+def decode(records, names):
+    """Yield (time, event, latency) for each record, latency in ms or None.
+
+    Dances carry the time since the press that started them, reports the longest
+    time since one of the presses they answer.
+    """
+    dances, states, layers = names
+    down = {}  # Position -> press time, for keys still held
+    waiting = []  # Presses that have not been followed by a report yet
+    for time, kind, a, b, c in records:
+        if kind in (KEY_DOWN, KEY_UP):
+            position = f"r{a >> 4}c{a & 0x0F}"
+            if kind == KEY_DOWN:
+                down[position] = time
+                waiting.append(position)
+                yield time, f"down {position} on {name(layers, b)}", None
+            else:
+                held = time - down.pop(position, time)
+                yield time, f"up   {position} after {held} ms", None
+        elif kind == DANCE:
+            # The press that started the dance is the most recent one still held, or the last one.
+            pressed = max(down.values(), default=time)
+            yield time, f"  dance {name(dances, a)} -> {name(states, b).lower()}", time - pressed
+        elif kind == REPORT:
+            delays = [time - down[position] for position in waiting if position in down]
+            yield time, f"  report {report_text(a, b, c)}", max(delays, default=None)
+            waiting.clear()
+        elif kind == STUCK:
+            yield time, f"  STUCK {report_text(a, b, c)}", None
+
+
+def print_timeline(records, names):
+    start = records[0][0]
+    for time, event, latency in decode(records, names):
+        suffix = f", {latency} ms after the press" if latency is not None else ""
+        print(f"{time - start:8} ms  {event}{suffix}")
+
+
+def write_session(records, out):
+    """Write the key events of a capture as a session for tests/replay.c."""
+    events = []
+    last_up = {}  # Position -> index of its last release in events
+    down = set()
+    for time, kind, a, _, _ in records:
+        if kind == KEY_DOWN and a not in down:
+            down.add(a)
+            events.append([time, a, 1])
+        elif kind == KEY_UP and a in down:
+            down.discard(a)
+            last_up[a] = len(events)
+            events.append([time, a, 0])
+        elif kind == KEY_UP and a in last_up:
+            # A release sent early by tap_hold.c, the physical one comes later.
+            events[last_up[a]][0] = time
+    events.sort(key=lambda event: event[0])
+
+    out.write("# Generated by tools/event_log.py --session, played back by tests/replay.c.\n")
+    out.write("# ms since the first event, then the key going down or up at its matrix row and column.\n")
+    start = events[0][0] if events else 0
+    for time, key, pressed in events:
+        out.write(f"{time - start} {'down' if pressed else 'up'} r{key >> 4}c{key & 0x0F}\n")
+
+
+def compare(golden, run, names, tolerance):
+    """Print how run differs from golden, return True when the output is the same."""
+    expected = [(event, latency) for _, event, latency in decode(golden, names) if "report" in event or "dance" in event]
+    actual = [(event, latency) for _, event, latency in decode(run, names) if "report" in event or "dance" in event]
+    same = True
+
+    diff = list(difflib.unified_diff([e for e, _ in expected], [e for e, _ in actual], "golden", "run", lineterm="", n=2))
+    for line in diff:
+        print(line)
+    if diff:
+        same = False
+    else:
+        moved = 0
+        for index, ((event, old), (_, new)) in enumerate(zip(expected, actual)):
+            if old is not None and new is not None and abs(new - old) > tolerance:
+                print(f"#{index:<5} {event.strip()}: {old} -> {new} ms")
+                moved += 1
+        print(f"same output, {moved} latencies moved by more than {tolerance} ms")
+
+    for label, outcomes in (("golden", expected), ("run", actual)):
+        latencies = [latency for event, latency in outcomes if latency is not None and "report" in event]
+        if latencies:
+            print(f"{label}: {len(latencies)} reports, {sum(latencies) / len(latencies):.1f} ms after the press on average, {max(latencies)} ms at worst")
+
+    stuck = [event for _, event, _ in decode(run, names) if "STUCK" in event]
+    for event in stuck:
+        print(f"run: {event.strip()} once every key was up")
+    return same and not stuck
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dump", nargs="?", type=argparse.FileType("r"), default=sys.stdin, help="console capture, stdin by default")
+    mode = parser.add_mutually_exclusive_group()
+    mode.add_argument("--session", action="store_true", help="write the key events as a session for tests/replay.c on stdout")
+    mode.add_argument("--golden", type=argparse.FileType("r"), help="compare the capture with this golden one")
+    parser.add_argument("--tolerance", type=int, default=5, help="latency change in ms worth listing, 5 by default")
+    args = parser.parse_args()
+
+    names = (
+        read_names("tap_dance.h", r"X\((\w+),"),
+        re.findall(r"TD_(\w+)", enum_body("tap_dance.c", "td_state_t")),
+        re.findall(r"(\w+)", enum_body("layers.h", "layer_names")),
+    )
+
+    records = list(parse(args.dump))
+    if not records:
+        sys.exit("no event log records found")
+
+    if args.session:
+        write_session(records, sys.stdout)
+    elif args.golden:
+        golden = list(parse(args.golden))
+        if not golden:
+            sys.exit("no event log records found in the golden capture")
+        sys.exit(0 if compare(golden, records, names, args.tolerance) else 1)
+    else:
+        print_timeline(records, names)
+
+
+if __name__ == "__main__":
+    main()
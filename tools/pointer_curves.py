@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Plot the cursor and wheel curves of pointer.c from the values in config.h.
+
+Simulates a key held for --hold ms and then released, frame by frame with the
+same fixed-point math as the firmware, and prints speed and distance per frame.
+With matplotlib installed, --plot FILE also draws them.
+
+    tools/pointer_curves.py --hold 1000 --plot curves.png
+"""
+
+import argparse
+import re
+from pathlib import Path
+
+KEYMAP_DIR = Path(__file__).resolve().parent.parent
+
+# Defaults of pointer.h, used for anything config.h does not set
+DEFAULTS = {
+    "POINTER_FRAME_MS": 16,
+    "POINTER_START_SPEED": 512,
+    "POINTER_ACCEL": 96,
+    "POINTER_MAX_SPEED": 5120,
+    "POINTER_FRICTION": 96,
+    "POINTER_STOP_SPEED": 64,
+    "WHEEL_START_SPEED": 32,
+    "WHEEL_ACCEL": 4,
+    "WHEEL_MAX_SPEED": 192,
+    "WHEEL_FRICTION": 16,
+    "WHEEL_STOP_SPEED": 16,
+}
+
+
+def read_config():
+    values = dict(DEFAULTS)
+    text = (KEYMAP_DIR / "config.h").read_text()
+    for name, value in re.findall(r"^#define\s+((?:POINTER|WHEEL)_\w+)\s+(\d+)", text, re.MULTILINE):
+        values[name] = int(value)
+    return values
+
+
+def tdiv(a, b):
+    """C integer division, truncating towards zero."""
+    quotient = abs(a) // abs(b)
+    return quotient if (a >= 0) == (b >= 0) else -quotient
+
+
+def simulate(config, prefix, hold_frames, total_frames):
+    """Yield (frame, speed in units per frame, distance in units) for one axis."""
+    start, accel, top = (config[f"{prefix}_{name}"] for name in ("START_SPEED", "ACCEL", "MAX_SPEED"))
+    friction, stop = config[f"{prefix}_FRICTION"], config[f"{prefix}_STOP_SPEED"]
+    speed = remainder = distance = 0
+    for frame in range(total_frames):
+        if frame < hold_frames:
+            speed = start if speed == 0 else min(speed + accel, top)
+        elif speed:
+            speed -= tdiv(speed * friction, 256)
+            if abs(speed) < stop:
+                speed = 0
+        position = remainder + speed
+        units = tdiv(position, 256)
+        remainder = position - units * 256 if speed else 0
+        distance += units
+        yield frame, speed / 256, distance
+        if frame >= hold_frames and speed == 0:
+            return
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--hold", type=int, default=1000, help="ms the key is held, default 1000")
+    parser.add_argument("--plot", metavar="FILE", help="draw the curves into FILE, needs matplotlib")
+    args = parser.parse_args()
+
+    config = read_config()
+    frame_ms = config["POINTER_FRAME_MS"]
+    # The press itself moves on frame 0, so a hold of N ms covers N / frame_ms + 1 frames.
+    hold_frames = args.hold // frame_ms + 1
+    curves = {
+        "cursor (px)": list(simulate(config, "POINTER", hold_frames, 10000)),
+        "wheel (steps)": list(simulate(config, "WHEEL", hold_frames, 10000)),
+    }
+
+    for name, samples in curves.items():
+        released = [sample for sample in samples if sample[0] >= hold_frames]
+        print(f"{name}: {samples[hold_frames - 1][2]} while held, {samples[-1][2]} in total, "
+              f"{len(released) * frame_ms} ms to stop after release")
+        print(f"{'ms':>6} {'speed/frame':>12} {'distance':>9}")
+        for frame, speed, distance in samples:
+            print(f"{frame * frame_ms:6} {speed:12.2f} {distance:9}")
+        print()
+
+    if args.plot:
+        import matplotlib.pyplot as plt
+
+        figure, axes = plt.subplots(2, 2, figsize=(10, 6), sharex=True)
+        for column, (name, samples) in enumerate(curves.items()):
+            times = [frame * frame_ms for frame, _, _ in samples]
+            axes[0][column].plot(times, [speed for _, speed, _ in samples])
+            axes[0][column].set_title(f"{name}: speed per frame")
+            axes[1][column].plot(times, [distance for _, _, distance in samples])
+            axes[1][column].set_title(f"{name}: distance")
+            axes[1][column].set_xlabel("ms")
+            for row in axes:
+                row[column].axvline(args.hold, color="grey", linestyle=":")
+        figure.tight_layout()
+        figure.savefig(args.plot)
+
+
+if __name__ == "__main__":
+    main()
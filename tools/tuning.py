@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Get and set the keymap's timing parameters over raw HID.
+
+The parameters and their order are read from tuning.h next to this directory,
+build with TUNING_ENABLE = yes. Changes apply right away and are lost on unplug
+unless saved:
+
+    tools/tuning.py                          list every parameter
+    tools/tuning.py set TAPPING_TERM 180     one or more name value pairs
+    tools/tuning.py toggle TAPPING_TERM 180 220
+    tools/tuning.py save                     keep the current values in EEPROM
+    tools/tuning.py reset                    back to the defaults from config.h
+
+toggle switches between two values on each run, for A/B testing while typing.
+The keyboard is found by the raw HID usage page in /sys/class/hidraw, or given
+with --device. Access to /dev/hidraw* usually needs a udev rule or root.
+"""
+
+import argparse
+import os
+import re
+import sys
+from pathlib import Path
+
+KEYMAP_DIR = Path(__file__).resolve().parent.parent
+
+CMD_INFO, CMD_GET, CMD_SET, CMD_SAVE, CMD_RESET = range(1, 6)
+STATUS = ["ok", "unknown command", "unknown parameter", "out of range"]
+REPORT_SIZE = 32
+# Usage page 0xFF60, as QMK's raw HID interface declares it
+RAW_USAGE_PAGE = bytes([0x06, 0x60, 0xFF])
+
+
+def parameter_names():
+    text = (KEYMAP_DIR / "tuning.h").read_text()
+    table = text[text.index("#define TUNING_TABLE") :]
+    table = table[: table.index("\n\n")]
+    return re.findall(r"X\((\w+),", table)
+
+
+def find_device():
+    for node in sorted(Path("/sys/class/hidraw").glob("hidraw*")):
+        try:
+            if RAW_USAGE_PAGE in (node / "device" / "report_descriptor").read_bytes():
+                return f"/dev/{node.name}"
+        except OSError:
+            continue
+    sys.exit("no raw HID keyboard found, pass --device")
+
+
+class Keyboard:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR)
+
+    def request(self, command, parameter=0, value=0):
+        packet = bytes([command, parameter, value & 0xFF, value >> 8]).ljust(REPORT_SIZE, b"\0")
+        # Report number 0 first, the raw HID interface has no numbered reports.
+        os.write(self.fd, b"\0" + packet)
+        while True:
+            reply = os.read(self.fd, REPORT_SIZE)
+            if reply[0] == command:
+                break
+        status = reply[1]
+        if status:
+            raise ValueError(STATUS[status] if status < len(STATUS) else f"status {status}")
+        word = lambda at: reply[at] | reply[at + 1] << 8
+        return word(3), word(5), word(7)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--device", help="hidraw node, found by its usage page by default")
+    parser.add_argument("command", nargs="?", default="list", choices=["list", "get", "set", "toggle", "save", "reset"])
+    parser.add_argument("args", nargs="*")
+    args = parser.parse_args()
+
+    names = parameter_names()
+    keyboard = Keyboard(args.device or find_device())
+    count, _, _ = keyboard.request(CMD_INFO)
+    if count != len(names):
+        sys.exit(f"the keyboard has {count} parameters and tuning.h {len(names)}, flash the current keymap")
+
+    def index(name):
+        try:
+            return names.index(name.upper())
+        except ValueError:
+            sys.exit(f"unknown parameter {name}, one of {', '.join(names)}")
+
+    def show(i, value, low, high):
+        print(f"{names[i]:<20} {value:6}   ({low}..{high})")
+
+    try:
+        if args.command in ("list", "get"):
+            for i in [index(name) for name in args.args] or range(len(names)):
+                show(i, *keyboard.request(CMD_GET, i))
+        elif args.command == "set":
+            if not args.args or len(args.args) % 2:
+                sys.exit("set takes name value pairs")
+            for name, value in zip(args.args[::2], args.args[1::2]):
+                i = index(name)
+                show(i, *keyboard.request(CMD_SET, i, int(value, 0)))
+        elif args.command == "toggle":
+            if len(args.args) != 3:
+                sys.exit("toggle takes a name and two values")
+            i = index(args.args[0])
+            a, b = (int(value, 0) for value in args.args[1:])
+            current, _, _ = keyboard.request(CMD_GET, i)
+            show(i, *keyboard.request(CMD_SET, i, b if current == a else a))
+        elif args.command == "save":
+            keyboard.request(CMD_SAVE)
+        elif args.command == "reset":
+            keyboard.request(CMD_RESET)
+    except ValueError as error:
+        sys.exit(str(error))
+
+
+if __name__ == "__main__":
+    main()
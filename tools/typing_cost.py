@@ -0,0 +1,336 @@
+#!/usr/bin/env python3
+"""Estimate what typing a text or code corpus costs on this keymap.
+
+Reads the layers of keymap.c, the dance table of tap_dance.h and the switches in
+config.h, then walks the corpus character by character, taking for each one the
+cheapest way the keymap offers to type it: a plain key, a dance tier, a mod-tap or
+layer-tap tap, with Shift or a layer thumb held where needed.
+
+    tools/typing_cost.py src/ docs/*.md
+    tools/typing_cost.py --keymap keymap.c --keymap /tmp/moved_braces.c src/
+
+For every symbol it reports the keystrokes, layer switches, dance taps and forced
+waits (a dance tier followed by the same dance, which has to wait out the tapping
+term). Then come the finger load and the most frequent same-finger bigrams. The
+time-to-type estimate adds up --stroke-ms per keystroke, --sfb-ms per same-finger
+bigram and the tapping term per forced wait. Give several --keymap files to compare
+placements side by side.
+"""
+
+import argparse
+import re
+import sys
+from collections import Counter
+from pathlib import Path
+
+KEYMAP_DIR = Path(__file__).resolve().parent.parent
+
+# Characters typed by the basic keycodes of a US layout, and what Shift turns them into
+BASIC = {f"KC_{chr(c)}": chr(c).lower() for c in range(ord("A"), ord("Z") + 1)}
+BASIC.update({f"KC_{d}": str(d) for d in range(10)})
+BASIC.update({
+    "KC_SPC": " ", "KC_ENT": "\n", "KC_TAB": "\t", "KC_MINS": "-", "KC_EQL": "=", "KC_LBRC": "[",
+    "KC_RBRC": "]", "KC_BSLS": "\\", "KC_SCLN": ";", "KC_QUOT": "'", "KC_GRV": "`", "KC_COMM": ",",
+    "KC_DOT": ".", "KC_SLSH": "/",
+})
+SHIFTED = dict(zip("1234567890-=[]\\;'`,./", "!@#$%^&*()_+{}|:\"~<>?"))
+SHIFTED.update({chr(c): chr(c).upper() for c in range(ord("a"), ord("z") + 1)})
+# Keycodes that carry their own Shift
+ALIASES = {
+    "KC_EXLM": "!", "KC_AT": "@", "KC_HASH": "#", "KC_DLR": "$", "KC_PERC": "%", "KC_CIRC": "^",
+    "KC_AMPR": "&", "KC_ASTR": "*", "KC_LPRN": "(", "KC_RPRN": ")", "KC_UNDS": "_", "KC_PLUS": "+",
+    "KC_LCBR": "{", "KC_RCBR": "}", "KC_PIPE": "|", "KC_COLN": ":", "KC_DQUO": '"', "KC_TILD": "~",
+    "KC_LT": "<", "KC_GT": ">", "KC_QUES": "?",
+}
+SHIFT_KEYCODES = {"KC_LSFT", "KC_RSFT"}
+
+FINGERS = {1: "pinky", 2: "ring", 3: "middle", 4: "index", 5: "index"}
+
+
+def finger(position):
+    """Finger that presses a layout position such as L24 or R11."""
+    side, row, col = position[0], int(position[1]), int(position[2])
+    if row == 4:
+        return f"{side} thumb"
+    # The right half counts its columns from the inside out.
+    return f"{side} {FINGERS[col if side == 'L' else 6 - col]}"
+
+
+def char_of(keycode):
+    """Character a keycode types, None for anything else."""
+    if keycode in ALIASES:
+        return ALIASES[keycode]
+    return BASIC.get(keycode)
+
+
+def read(path):
+    try:
+        return Path(path).read_text()
+    except OSError as error:
+        sys.exit(str(error))
+
+
+def config_switches():
+    text = read(KEYMAP_DIR / "config.h")
+    defines = dict(re.findall(r"^#define\s+(\w+)(?:[ \t]+(\S+))?", text, re.MULTILINE))
+    return defines
+
+
+def dance_table():
+    dances = {}
+    for row in re.findall(r"X\((\w+),\s*(\d+),\s*([\w|() <]+?),\s*(\w+),\s*(\w+),\s*(\w+),\s*(\w+)\)", read(KEYMAP_DIR / "tap_dance.h")):
+        name, _, flags, single_tap, single_hold, double_tap, _ = row
+        dances[name] = {"tap": single_tap, "hold": single_hold, "double": double_tap, "pair": "TD_PAIR" in flags}
+    return dances
+
+
+def parse_keymap(path, switches):
+    """Return the layers as {layer: {position: keycode}}, the thumbs held to reach each
+    layer as {layer: [positions]}, and the symbol mod-taps in use as {dance: row}.
+    """
+    text = read(path)
+    layers = {}
+    for name, body in re.findall(r"\[(\w+)\]\s*=\s*LAYOUT_split_3x5_2\((.*?)\n\s*\)", text, re.DOTALL):
+        layers[name] = {pos: keycode.strip().rstrip(",").strip() for pos, keycode in re.findall(r"/\*(\w+)\*/\s*([^\n]+)", body)}
+
+    lists = {}
+    for name, body in re.findall(r"#define\s+(\w+_KEYS)\(X\)((?:\s*\\\s*X\([^)]*\))+)", text):
+        lists[name] = dict(re.findall(r"X\((\w+),\s*(\w+)\)", body))
+    for layer, keys in re.findall(r"\[(\w+)\s*-\s*FIRST_SPARSE_LAYER\]\s*=\s*SPARSE_LAYER\(\w+,\s*(\w+)\)", text):
+        layers[layer] = lists.get(keys, {})
+
+    symbol_mod_taps = {}
+    if "SYMBOL_MOD_TAPS" in switches:
+        for dance, mod_tap, tap, shifted in re.findall(r"X\((\w+),\s*(\w+\(\w+\)),\s*(\w+),\s*(\w+)\)", text):
+            symbol_mod_taps[dance] = (mod_tap, tap, shifted)
+    for keys in layers.values():
+        for position, keycode in keys.items():
+            match = re.fullmatch(r"SYMBOL_KEY\((\w+)\)", keycode)
+            if match:
+                dance = match.group(1)
+                keys[position] = f"SMT({dance})" if dance in symbol_mod_taps else f"TD({dance})"
+
+    access = {"BASE": []}
+    for position, keycode in layers.get("BASE", {}).items():
+        match = re.fullmatch(r"LT\((\w+),\s*\w+\)", keycode)
+        if match:
+            access[match.group(1)] = [position]
+    for a, b, c in re.findall(r"update_tri_layer_state\(\w+,\s*(\w+),\s*(\w+),\s*(\w+)\)", text):
+        if a in access and b in access:
+            access[c] = access[a] + access[b]
+    return layers, access, symbol_mod_taps
+
+
+class Option:
+    """One way to type a character: presses of one key, maybe with a hold key and a layer."""
+
+    def __init__(self, layer, position, presses=1, hold=None, dance=None):
+        self.layer = layer
+        self.position = position
+        self.presses = presses
+        self.hold = hold  # Positions that can hold Shift (or PARTNER) for it, any one will do
+        self.dance = dance
+
+
+def typing_options(layers, access, dances, symbol_mod_taps, switches):
+    """Map every character the keymap can type to its options."""
+    options = {}
+
+    def add(char, option):
+        if char:
+            options.setdefault(char, []).append(option)
+
+    for layer, keys in layers.items():
+        if layer not in access:
+            continue
+        shifts = []
+        partner = []
+        for position, keycode in keys.items():
+            dance = re.fullmatch(r"TD\((\w+)\)", keycode)
+            smt = re.fullmatch(r"SMT\((\w+)\)", keycode)
+            if (
+                keycode in SHIFT_KEYCODES
+                or re.fullmatch(r"[LR]SFT_T\(\w+\)", keycode)
+                or (dance and dances.get(dance.group(1), {}).get("hold") in SHIFT_KEYCODES)
+                or (smt and re.fullmatch(r"[LR]SFT_T\(\w+\)", symbol_mod_taps[smt.group(1)][0]))
+            ):
+                shifts.append(position)
+            if keycode == "PARTNER":
+                partner.append(position)
+
+        for position, keycode in keys.items():
+            match = re.fullmatch(r"(?:\w+_T|LT)\((?:\w+,\s*)?(\w+)\)", keycode)
+            if match:
+                keycode = match.group(1)
+            dance = re.fullmatch(r"TD\((\w+)\)", keycode)
+            smt = re.fullmatch(r"SMT\((\w+)\)", keycode)
+            if smt:
+                _, tap, shifted = symbol_mod_taps[smt.group(1)]
+                add(char_of(tap), Option(layer, position))
+                add(char_of(shifted), Option(layer, position, hold=shifts))
+            elif dance and dance.group(1) in dances:
+                name = dance.group(1)
+                row = dances[name]
+                if row["pair"] and "TAP_DANCE_OVERRIDES" in switches:
+                    add(char_of(row["tap"]), Option(layer, position))
+                    add(char_of(row["double"]), Option(layer, position, hold=shifts + partner))
+                    continue
+                add(char_of(row["tap"]), Option(layer, position, dance=name))
+                add(char_of(row["double"]), Option(layer, position, presses=2, dance=name))
+                if row["tap"] in BASIC and char_of(row["tap"]) in SHIFTED:
+                    add(SHIFTED[char_of(row["tap"])], Option(layer, position, hold=[p for p in shifts if p != position], dance=name))
+            else:
+                char = char_of(keycode)
+                add(char, Option(layer, position))
+                if keycode in BASIC and char in SHIFTED:
+                    add(SHIFTED[char], Option(layer, position, hold=[p for p in shifts if p != position]))
+    return options
+
+
+class Tally:
+    def __init__(self):
+        self.count = 0
+        self.strokes = 0
+        self.layer_switches = 0
+        self.dance_taps = 0
+        self.waits = 0
+        self.time = 0.0
+
+
+def analyze(text, options, access, args, tapping_term):
+    state = {"layer": "BASE", "hold": None, "finger": None, "position": None, "dance": None}
+    symbols = {}
+    load = Counter()
+    sfbs = Counter()
+    missing = Counter()
+    total = Tally()
+
+    def cost(option):
+        """Return (time, strokes, layer switch, wait, [positions pressed in order])."""
+        pressed = []
+        switch = option.layer != state["layer"]
+        if switch:
+            pressed += access[option.layer]
+        hold = None
+        if option.hold is not None:
+            if not option.hold:
+                return None
+            # Shift on the other hand from the key, already held when it can be.
+            hold = state["hold"] if state["hold"] in option.hold and not switch else None
+            if hold is None:
+                others = [p for p in option.hold if p[0] != option.position[0]] or option.hold
+                hold = others[0]
+                pressed.append(hold)
+        pressed += [option.position] * option.presses
+        wait = option.dance is not None and option.dance == state["dance"]
+
+        time = len(pressed) * args.stroke_ms + (tapping_term if wait else 0)
+        previous = state["position"]
+        for position in pressed:
+            if previous and position != previous and finger(position) == finger(previous):
+                time += args.sfb_ms
+            previous = position
+        return time, pressed, switch, wait, hold
+
+    for char in text:
+        if char == "\r":
+            continue
+        if char not in options:
+            missing[char] += 1
+            continue
+        best = None
+        for option in options[char]:
+            result = cost(option)
+            if result and (best is None or result[0] < best[1][0]):
+                best = (option, result)
+        if best is None:
+            missing[char] += 1
+            continue
+        option, (time, pressed, switch, wait, hold) = best
+
+        tally = symbols.setdefault(char, Tally())
+        for t in (tally, total):
+            t.count += 1
+            t.strokes += len(pressed)
+            t.layer_switches += switch
+            t.dance_taps += option.presses if option.dance else 0
+            t.waits += wait
+            t.time += time
+        previous = state["position"]
+        for position in pressed:
+            load[finger(position)] += 1
+            if previous and position != previous and finger(position) == finger(previous):
+                sfbs[(previous, position)] += 1
+            previous = position
+
+        state.update(layer=option.layer, hold=hold, position=pressed[-1], dance=option.dance)
+    return symbols, load, sfbs, missing, total
+
+
+def printable(char):
+    return {" ": "space", "\n": "enter", "\t": "tab"}.get(char, char)
+
+
+def report(name, result, args):
+    symbols, load, sfbs, missing, total = result
+    if not total.count:
+        print(f"{name}: nothing to type")
+        return
+    minutes = total.time / 60000
+    print(f"== {name}")
+    print(f"{total.count} characters, {total.strokes} keystrokes ({total.strokes / total.count:.2f} per character)")
+    print(f"{total.layer_switches} layer switches, {total.dance_taps} dance taps, {total.waits} forced waits, {sum(sfbs.values())} same-finger bigrams")
+    print(f"about {total.time / 1000:.1f} s to type, {total.count / 5 / minutes:.1f} wpm")
+
+    print("\nsymbol     count  strokes  layer  dance  waits   time")
+    ranked = sorted(symbols.items(), key=lambda item: -item[1].time)
+    for char, tally in ranked[: args.top]:
+        print(f"{printable(char):<8} {tally.count:7} {tally.strokes / tally.count:8.2f} {tally.layer_switches:6} {tally.dance_taps:6} {tally.waits:6} {100 * tally.time / total.time:5.1f}%")
+
+    print("\nfinger load")
+    strokes = sum(load.values())
+    for finger_name, count in sorted(load.items()):
+        print(f"  {finger_name:<10} {100 * count / strokes:5.1f}%")
+    if sfbs:
+        print("\nsame-finger bigrams")
+        for (a, b), count in sfbs.most_common(args.top):
+            print(f"  {a} {b}  {count}")
+    if missing:
+        print("\ncannot type: " + " ".join(f"{printable(c)!r}x{n}" for c, n in missing.most_common()))
+    print()
+
+
+def corpus(paths):
+    if not paths:
+        yield sys.stdin.read()
+        return
+    for path in map(Path, paths):
+        files = sorted(p for p in path.rglob("*") if p.is_file()) if path.is_dir() else [path]
+        for file in files:
+            try:
+                yield file.read_text()
+            except (OSError, UnicodeDecodeError):
+                continue
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("corpus", nargs="*", help="files or directories to type, stdin by default")
+    parser.add_argument("--keymap", action="append", help="keymap.c to analyze, can be given several times")
+    parser.add_argument("--stroke-ms", type=float, default=180, help="time per keystroke, 180 by default")
+    parser.add_argument("--sfb-ms", type=float, default=100, help="extra time per same-finger bigram, 100 by default")
+    parser.add_argument("--top", type=int, default=15, help="rows in the per-symbol and bigram lists")
+    args = parser.parse_args()
+
+    switches = config_switches()
+    tapping_term = int(switches.get("TAPPING_TERM") or 200)
+    dances = dance_table()
+    text = "".join(corpus(args.corpus))
+    for path in args.keymap or [KEYMAP_DIR / "keymap.c"]:
+        layers, access, symbol_mod_taps = parse_keymap(path, switches)
+        options = typing_options(layers, access, dances, symbol_mod_taps, switches)
+        report(str(path), analyze(text, options, access, args, tapping_term), args)
+
+
+if __name__ == "__main__":
+    main()
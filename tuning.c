@@ -0,0 +1,120 @@
+#include QMK_KEYBOARD_H
+
+#include "tuning.h"
+#ifdef TUNING_ENABLE
+#    include "raw_hid.h"
+#endif
+
+typedef struct {
+    uint16_t value;
+    uint16_t min;
+    uint16_t max;
+} tuning_param_t;
+
+#define TUNING_PARAM(parameter, value, min, max) [TUNING_##parameter] = {value, min, max},
+
+static const tuning_param_t params[] PROGMEM = {
+    TUNING_TABLE(TUNING_PARAM)
+};
+
+uint16_t tuning[TUNING_COUNT];
+
+static void tuning_defaults(void) {
+    for (uint8_t i = 0; i < TUNING_COUNT; i++) {
+        tuning[i] = pgm_read_word(&params[i].value);
+    }
+}
+
+#ifdef TUNING_ENABLE
+// Bump when the table changes, saved values of another version are dropped
+#    define TUNING_EECONFIG_VERSION 1
+
+typedef struct {
+    uint8_t  version;
+    uint8_t  count;
+    uint16_t values[TUNING_COUNT];
+} tuning_eeconfig_t;
+
+static bool tuning_in_range(uint8_t parameter, uint16_t value) {
+    return value >= pgm_read_word(&params[parameter].min) && value <= pgm_read_word(&params[parameter].max);
+}
+
+_Static_assert(TUNING_EEPROM_OFFSET + sizeof(tuning_eeconfig_t) <= EECONFIG_USER_DATA_SIZE, "EECONFIG_USER_DATA_SIZE is too small for the tuning parameters");
+
+#    define TUNING_EEPROM ((void *)(EECONFIG_USER_DATABLOCK + TUNING_EEPROM_OFFSET))
+
+static void tuning_load(void) {
+    tuning_eeconfig_t saved;
+    eeprom_read_block(&saved, TUNING_EEPROM, sizeof(saved));
+    if (saved.version != TUNING_EECONFIG_VERSION || saved.count != TUNING_COUNT) return;
+    for (uint8_t i = 0; i < TUNING_COUNT; i++) {
+        if (tuning_in_range(i, saved.values[i])) tuning[i] = saved.values[i];
+    }
+}
+
+static void tuning_save(void) {
+    tuning_eeconfig_t saved = {.version = TUNING_EECONFIG_VERSION, .count = TUNING_COUNT};
+    memcpy(saved.values, tuning, sizeof(tuning));
+    eeprom_update_block(&saved, TUNING_EEPROM, sizeof(saved));
+}
+
+static void put_word(uint8_t *data, uint16_t value) {
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+void raw_hid_receive(uint8_t *data, uint8_t length) {
+    uint8_t  command   = data[0];
+    uint8_t  parameter = data[1];
+    uint16_t value     = data[2] | data[3] << 8;
+    uint8_t  status    = TUNING_OK;
+
+    switch (command) {
+        case TUNING_CMD_INFO:
+            value = TUNING_COUNT;
+            break;
+        case TUNING_CMD_GET:
+        case TUNING_CMD_SET:
+            if (parameter >= TUNING_COUNT) {
+                status = TUNING_BAD_PARAMETER;
+                break;
+            }
+            if (command == TUNING_CMD_SET) {
+                if (tuning_in_range(parameter, value)) {
+                    tuning[parameter] = value;
+                } else {
+                    status = TUNING_OUT_OF_RANGE;
+                }
+            }
+            value = tuning[parameter];
+            break;
+        case TUNING_CMD_SAVE:
+            tuning_save();
+            break;
+        case TUNING_CMD_RESET:
+            tuning_defaults();
+            break;
+        default:
+            status = TUNING_BAD_COMMAND;
+            break;
+    }
+
+    memset(data, 0, length);
+    data[0] = command;
+    data[1] = status;
+    data[2] = parameter;
+    put_word(&data[3], value);
+    if (parameter < TUNING_COUNT) {
+        put_word(&data[5], pgm_read_word(&params[parameter].min));
+        put_word(&data[7], pgm_read_word(&params[parameter].max));
+    }
+    raw_hid_send(data, length);
+}
+#endif
+
+void tuning_init(void) {
+    tuning_defaults();
+#ifdef TUNING_ENABLE
+    tuning_load();
+#endif
+}
@@ -0,0 +1,63 @@
+#ifndef FERRIS_SWEEP_TUNING_H
+#define FERRIS_SWEEP_TUNING_H
+
+#include "pointer.h"
+#include "tap_hold.h"
+
+/* Timing parameters read at run time instead of compiled in, one row per parameter.
+ *
+ * The defaults are the values in config.h. With TUNING_ENABLE, tools/tuning.py reads
+ * and sets them over raw HID while typing, and saves them to EEPROM. Parameters are
+ * addressed by their row in this table, the tool reads the names from here.
+ *
+ * The pointer and wheel curves keep their fields in the same order, see pointer.c.
+ * TAPPING_TERM stops at TAPPING_TERM_MAX, which tap_hold.c and scan_sched.c rely on,
+ * and a friction or stop speed of 0 would never let the pointer stop.
+ */
+#define TUNING_TABLE(X) \
+    /* parameter            default               min  max */ \
+    X(TAPPING_TERM,        TAPPING_TERM,         50,  TAPPING_TERM_MAX) \
+    X(QUICK_TAP_TERM,      QUICK_TAP_TERM,       0,   1000) \
+    X(POINTER_FRAME_MS,    POINTER_FRAME_MS,     1,   100) \
+    X(POINTER_START_SPEED, POINTER_START_SPEED,  0,   32511) \
+    X(POINTER_ACCEL,       POINTER_ACCEL,        0,   32511) \
+    X(POINTER_MAX_SPEED,   POINTER_MAX_SPEED,    0,   32511) \
+    X(POINTER_FRICTION,    POINTER_FRICTION,     1,   255) \
+    X(POINTER_STOP_SPEED,  POINTER_STOP_SPEED,   1,   32511) \
+    X(WHEEL_START_SPEED,   WHEEL_START_SPEED,    0,   32511) \
+    X(WHEEL_ACCEL,         WHEEL_ACCEL,          0,   32511) \
+    X(WHEEL_MAX_SPEED,     WHEEL_MAX_SPEED,      0,   32511) \
+    X(WHEEL_FRICTION,      WHEEL_FRICTION,       1,   255) \
+    X(WHEEL_STOP_SPEED,    WHEEL_STOP_SPEED,     1,   32511)
+
+#define TUNING_ENUM(parameter, ...) TUNING_##parameter,
+
+enum tuning_parameters {
+    TUNING_TABLE(TUNING_ENUM)
+    TUNING_COUNT
+};
+
+// Raw HID requests are [command, parameter, value (LE)], replies [command, status, parameter, value, min, max (LE)]
+enum tuning_commands {
+    TUNING_CMD_INFO = 1, // Value is the number of parameters
+    TUNING_CMD_GET,
+    TUNING_CMD_SET,
+    TUNING_CMD_SAVE,  // Write every value to EEPROM
+    TUNING_CMD_RESET, // Back to the defaults, without saving
+};
+
+enum tuning_status {
+    TUNING_OK,
+    TUNING_BAD_COMMAND,
+    TUNING_BAD_PARAMETER,
+    TUNING_OUT_OF_RANGE,
+};
+
+// Where the saved values start in the EECONFIG user datablock, after tap_hold.c's learned terms
+#define TUNING_EEPROM_OFFSET 32
+
+extern uint16_t tuning[TUNING_COUNT];
+
+void tuning_init(void);
+
+#endif